@@ -7,6 +7,7 @@
 #include <magic_enum/magic_enum.hpp>
 #include <magic_enum/magic_enum_iostream.hpp>
 #include <mlplc/mlplc.hpp>
+#include <dsp/dsp.hpp>
 
 #include <zephyr/sys/sys_heap.h>
 
@@ -21,6 +22,7 @@ using namespace std::chrono_literals;
 
 constexpr std::size_t THREAD_STRESS_TEST_COUNT = 20;
 constexpr std::size_t THREAD_STRESS_TEST_STACK_SIZE = 1024;
+constexpr std::size_t THREAD_POOL_TEST_WORKERS = 4;
 
 constexpr std::size_t MY_STATIC_THREAD_STACK_SIZE = 4500;
 constexpr std::string_view BUTTON = "BUTTON";
@@ -52,10 +54,22 @@ void my_thread_func(int const arg) {
 void led_handle(std::chrono::milliseconds duration) {
     periph::DigitalInput button(BUTTON);
     periph::DigitalOutput led_r(LED_R);
-    auto const t_stop = sys::uptime() + duration;
-    while (sys::uptime() < t_stop) {
+    sys::CyclicTask led_task("led_cycle", 1ms, [&]() {
         led_r.set_level(!button.level());
-        sys::sleep(1ms);
+    }, 1024, 0);
+    led_task.start();
+    sys::sleep(duration);
+    led_task.stop();
+    auto const stats = led_task.stats();
+    LOG_INF("led_cycle: cycles=%u overruns=%u exec_max=%lldus jitter_max=%lldus jitter_p99=%lldus",
+        stats.cycles, stats.overruns, stats.exec_max.count(), stats.jitter_max.count(),
+        stats.jitter_percentile(99).count());
+    auto const history = button.edge_history();
+    LOG_INF("button edges: total=%u", history.total);
+    for (std::size_t i = 0; i < history.size; i++) {
+        LOG_INF("button edge: t=%lldus level=%s",
+            std::chrono::duration_cast<std::chrono::microseconds>(history.edges[i].time).count(),
+            level_to_str(history.edges[i].level));
     }
 }
 
@@ -77,6 +91,32 @@ void exception_thread_func() {
     throw std::runtime_error("exception_thread_func:");
 }
 
+sys::Task blink_task(sys::Scheduler& scheduler, periph::DigitalOutput& led, std::chrono::milliseconds period,
+    std::size_t count)
+{
+    for (std::size_t i = 0; i < count; i++) {
+        led.set_level(periph::Level::High);
+        co_await sys::delay(period);
+        led.set_level(periph::Level::Low);
+        co_await sys::delay(period);
+    }
+    LOG_INF("blink_task: done, stop scheduler");
+    scheduler.stop();
+}
+
+sys::Task pulse_task(periph::DigitalOutput& led) {
+    led.pulse_start(50ms, 50ms, 5);
+    co_await led.pulse_done();
+    LOG_INF("pulse_task: pulse done");
+}
+
+sys::Task button_task(periph::DigitalInput const& button) {
+    while (1) {
+        co_await button.edge(periph::Level::High);
+        LOG_INF("button_task: pressed");
+    }
+}
+
 int main(void) {
     mlplc::init(on_fatal_error);
     LOG_INF("Hello from MLPLC!");
@@ -117,6 +157,17 @@ int main(void) {
             LOG_INF("My thread created! Join..");
             my_thread.join();
         }
+        sys::sleep(10ms);
+        {
+            LOG_INF("Try create in-place thread with move-only arg..");
+            static auto inplace_thread = sys::make_thread<1024>("inplace_thread", 0,
+                [](int arg, std::unique_ptr<int> value) {
+                    LOG_INF("inplace_thread: arg=%i value=%i", arg, *value);
+                }, 7, std::make_unique<int>(42));
+            inplace_thread.start();
+            inplace_thread.join();
+            LOG_INF("Join complete, is_finished=%i", inplace_thread.is_finished());
+        }
 
         {
             sys::sleep(10ms);
@@ -144,6 +195,27 @@ int main(void) {
             }
         }
 
+        {
+            LOG_INF("Run stress test tasks on thread pool..");
+            sys::ThreadPool pool("pool_worker", THREAD_POOL_TEST_WORKERS, THREAD_STRESS_TEST_COUNT,
+                THREAD_STRESS_TEST_STACK_SIZE, 0);
+            std::vector<sys::TaskHandle> tasks{};
+            for (std::size_t i = 0; i < THREAD_STRESS_TEST_COUNT; i++) {
+                tasks.push_back(*pool.submit([i]() { thread_stress_test_func(i); }));
+            }
+            for (auto& task : tasks) {
+                task.wait();
+            }
+            LOG_INF("Thread pool tasks complete");
+        }
+
+        {
+            LOG_INF("Probe busy port without exception..");
+            periph::DigitalInput const input0(0);
+            auto const output0 = periph::DigitalOutput::new_unique(0);
+            LOG_INF("output0: %s", output0 ? "created" : output0.error().message().c_str());
+        }
+
         {
             // sys::sleep(10ms);
             // LOG_INF("Try create dyn stack overflowed thread..");
@@ -163,9 +235,154 @@ int main(void) {
         }
 
         {
-            periph::DigitalOutput led_r("LED_R");
-            periph::DigitalOutput led_g("LED_G");
-            periph::DigitalOutput led_b("LED_B");
+            LOG_INF("Run coroutine tasks..");
+            auto button = periph::DigitalInput::of<"BUTTON">();
+            auto led_g = periph::DigitalOutput::of<"LED_G">();
+            auto led_b = periph::DigitalOutput::of<"LED_B">();
+            sys::Scheduler scheduler;
+            scheduler.spawn(button_task(button));
+            scheduler.spawn(pulse_task(led_b));
+            scheduler.spawn(blink_task(scheduler, led_g, 100ms, 20));
+            scheduler.run();
+            LOG_INF("Scheduler stopped, tasks left=%zu", scheduler.task_count());
+        }
+
+        {
+            LOG_INF("Wait any of button press, pulse end and thread completion..");
+            auto button = periph::DigitalInput::of<"BUTTON">();
+            auto led_b = periph::DigitalOutput::of<"LED_B">();
+            auto worker = sys::Thread<>("poll_worker", []() { sys::sleep(300ms); }, 1024, 0);
+            sys::Poller poller;
+            std::size_t const button_src = poller.add(button, level_to_int(periph::Level::High));
+            std::size_t const pulse_src = poller.add(led_b);
+            std::size_t const worker_src = poller.add(worker);
+            led_b.pulse_start(100ms, 100ms, 3);
+            worker.start();
+            while (sys::poll_mask_t const fired = poller.wait(2000ms)) {
+                LOG_INF("poller: button=%i pulse_end=%i worker_done=%i", !!(fired & BIT(button_src)),
+                    !!(fired & BIT(pulse_src)), !!(fired & BIT(worker_src)));
+            }
+            worker.join();
+        }
+
+        {
+            LOG_INF("Count button presses..");
+            auto counter = periph::PulseCounter::of<"BUTTON">(periph::CountMode::Auto, periph::CountEdge::Falling);
+            sys::sleep(3000ms);
+            float const rate = counter.rate();
+            LOG_INF("pulse counter: mode=%i count=%u rate=%.2fHz", static_cast<int>(counter.mode()),
+                counter.reset(), static_cast<double>(rate));
+        }
+
+        {
+            LOG_INF("Measure button signal..");
+            auto input = periph::FrequencyInput::of<"BUTTON">(500ms);
+            sys::sleep(3000ms);
+            if (auto const m = input.measurement()) {
+                LOG_INF("frequency input: source=%i f=%.2fHz period=%lldus duty=%.2f periods=%u",
+                    static_cast<int>(input.source()), static_cast<double>(m->frequency),
+                    std::chrono::duration_cast<std::chrono::microseconds>(m->period).count(),
+                    static_cast<double>(m->duty), m->periods);
+            } else {
+                LOG_INF("frequency input: no signal");
+            }
+        }
+
+#if defined(CONFIG_ADC)
+        {
+            LOG_INF("Sample analog inputs..");
+            periph::AnalogGroup analog({dtb::adc_idx_of<"AIN0">(), dtb::adc_idx_of<"AIN1">()}, 100us, 1000);
+            std::array<int16_t, 2> once{};
+            analog.read(once);
+            LOG_INF("analog: ain0=%imV ain1=%imV", analog.to_millivolts(0, once[0]), analog.to_millivolts(1, once[1]));
+            // 12-bit samples at 10 kHz to 15-bit at 625 Hz.
+            dsp::Decimator<dsp::q15_t> decimator({.ratio = 16, .order = 3, .input_bits = 12, .output_bits = 15});
+            std::array<dsp::q15_t, 1000 / 16 + 1> decimated{};
+            analog.start();
+            for (std::size_t i = 0; i < 10; i++) {
+                auto const block = analog.wait_block(1000ms);
+                if (!block) {
+                    break;
+                }
+                int32_t sum = 0;
+                for (std::size_t s = 0; s < block->samplings(); s++) {
+                    sum += block->at(s, 0);
+                }
+                auto const ain0 = dsp::Channel<int16_t>::interleaved(block->samples(), block->channels(),
+                    analog.position(0));
+                std::size_t const count = decimator.process(ain0, decimated);
+                LOG_INF("analog block %u: ain0 mean=%i decimated=%i", block->sequence(),
+                    static_cast<int>(sum / static_cast<int32_t>(block->samplings())),
+                    count ? decimated[count - 1] : 0);
+            }
+            analog.stop();
+            auto const stats = analog.stats();
+            LOG_INF("analog: blocks=%u overruns=%u errors=%u", stats.blocks, stats.overruns, stats.errors);
+        }
+#endif
+
+        {
+            LOG_INF("Modbus register map..");
+            modbus::RegisterMap map({.coils = {0, 16}, .input_registers = {0, 8}, .holding_registers = {100, 32}});
+            map.set_reg(modbus::Table::InputRegisters, 0, 1234);
+            // Transport writes a block, as for "write multiple registers" request.
+            std::array<uint16_t, 3> const request{10, 20, 30};
+            map.client_write(modbus::Table::HoldingRegisters, 110, request);
+            map.take_changed(modbus::Table::HoldingRegisters, [&map](uint16_t addr) {
+                LOG_INF("modbus: holding register %u changed to %u", addr,
+                    map.reg(modbus::Table::HoldingRegisters, addr));
+            });
+        }
+
+#if defined(CONFIG_UART_ASYNC_API)
+        {
+            LOG_INF("Echo serial frames..");
+            auto serial = periph::Serial::of<"RS485">({.baudrate = 115200});
+            static constexpr std::string_view hello = "mlplc\r\n";
+            serial.write<uint8_t>({reinterpret_cast<uint8_t const*>(hello.data()), hello.size()});
+            for (std::size_t i = 0; i < 5; i++) {
+                auto const frame = serial.wait_frame(2000ms);
+                if (!frame) {
+                    break;
+                }
+                // Frame is sent back straight from RX ring.
+                serial.write_all(frame->first);
+                serial.write_all(frame->second);
+                serial.consume(frame->size());
+            }
+            serial.flush(100ms);
+            auto const stats = serial.stats();
+            LOG_INF("serial: frames=%u overruns=%u errors=%u", stats.frames, stats.overruns, stats.errors);
+        }
+
+        {
+            LOG_INF("Poll Modbus RTU slave..");
+            auto serial = periph::Serial::of<"RS485">({.baudrate = 19200, .parity = periph::Parity::Even});
+            modbus::RtuPoller poller(serial);
+            // Adjacent ranges polled together are read by one request.
+            auto const status = poller.add({.slave = 1, .table = modbus::Table::HoldingRegisters, .start = 0,
+                .count = 4, .period = 100ms});
+            auto const setpoints = poller.add({.slave = 1, .table = modbus::Table::HoldingRegisters, .start = 4,
+                .count = 8, .period = 100ms});
+            poller.start();
+            sys::sleep(1000ms);
+            std::array<uint16_t, 4> values{};
+            auto const result = poller.read(status, values);
+            LOG_INF("modbus: status=%u value=%u version=%u", static_cast<unsigned>(result.status), values[0],
+                result.version);
+            LOG_INF("modbus: setpoints version=%u", poller.read(setpoints, {}).version);
+            poller.stop();
+            if (auto const stats = poller.slave_stats(1)) {
+                LOG_INF("modbus: requests=%u timeouts=%u latency avg=%lldus", stats->requests, stats->timeouts,
+                    static_cast<long long>(stats->latency_avg.count()));
+            }
+        }
+#endif
+
+        {
+            auto led_r = periph::DigitalOutput::of<"LED_R">();
+            auto led_g = periph::DigitalOutput::of<"LED_G">();
+            auto led_b = periph::DigitalOutput::of<"LED_B">();
             led_r.pulse_start(500ms, 500ms);
             led_g.pulse_start(400ms, 400ms);
             led_b.pulse_start(300ms, 300ms);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+
+#include <zephyr/kernel.h>
+
+#include <expected>
+#include <source_location>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+
+namespace mlplc {
+
+/** Compact error of non-throwing API: error type, C return code and place of failure.
+ * Nothing is formatted until message() is called, so creating and returning error costs few words.
+ */
+struct Error {
+    ExceptionType type = ExceptionType::Unknown;
+    int rc = 0;
+    std::source_location where = std::source_location::current();
+
+    std::string message() const;
+};
+
+template<typename T>
+using expected = std::expected<T, Error>;
+
+/// Throw error as Exception, or panic if built without exceptions.
+[[noreturn]] void raise(Error const& error);
+
+/// Value of expected, error is raised.
+template<typename T>
+T unwrap(expected<T>&& result) {
+    if (!result) {
+        raise(result.error());
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
+
+} // namespace mlplc
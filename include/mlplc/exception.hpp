@@ -18,6 +18,7 @@ enum class ExceptionType : int32_t {
     PortAlreadyInUse,
     ObjectMoved,
     DestroyingRunningThread,
+    InvalidArgument,
 };
 
 constexpr ExceptionType exception_type_from_c_code(int error_code) {
@@ -1,8 +1,17 @@
 #pragma once
 
+#include "error.hpp"
 #include "sys/sys.hpp"
 #include "periph/digital_input.hpp"
 #include "periph/digital_output.hpp"
+#include "periph/digital_group.hpp"
+#include "periph/pulse_counter.hpp"
+#include "periph/frequency_input.hpp"
+#include "periph/analog_group.hpp"
+#include "periph/serial.hpp"
+#include "periph/process_image.hpp"
+#include "modbus/register_map.hpp"
+#include "modbus/rtu_poller.hpp"
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/sys.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <memory>
+#include <optional>
+#include <span>
+#include <cstdint>
+
+#if defined(CONFIG_MODBUS)
+#include <zephyr/modbus/modbus.h>
+#endif
+
+namespace mlplc {
+namespace modbus {
+
+enum class Table : uint8_t {
+    Coils,
+    DiscreteInputs,
+    InputRegisters,
+    HoldingRegisters,
+};
+
+constexpr std::size_t TABLE_COUNT = 4;
+
+constexpr bool is_bit_table(Table table) {
+    return Table::Coils == table || Table::DiscreteInputs == table;
+}
+
+/// Tables written by clients. Client writes mark elements as changed.
+constexpr bool is_client_writable(Table table) {
+    return Table::Coils == table || Table::HoldingRegisters == table;
+}
+
+/// Addresses of table, count 0 is absent table.
+struct TableRange {
+    uint16_t start = 0;
+    uint16_t count = 0;
+};
+
+struct RegisterMapLayout {
+    TableRange coils{};
+    TableRange discrete_inputs{};
+    TableRange input_registers{};
+    TableRange holding_registers{};
+};
+
+/** Modbus data model shared by all transports - RTU, ASCII and TCP servers may serve one map at once.
+ * Each table is contiguous storage: registers are 16-bit words, bits are packed 16 per word,
+ * so block access of request is plain copy.
+ * Tables are split into stripes of REGISTERS_PER_LOCK registers (BITS_PER_LOCK bits), each with own spinlock.
+ * Block access locks only stripes it touches, in address order, so every request sees consistent block
+ * while requests to other stripes proceed.
+ * Client writes set per-element dirty bits, application finds changes by scan of dirty bitmap -
+ * take_changed(), without comparing values.
+ *
+ * Methods return false if address range is outside of table.
+ */
+class RegisterMap {
+public:
+    static constexpr std::size_t REGISTERS_PER_LOCK = 32;
+    static constexpr std::size_t BITS_PER_LOCK = REGISTERS_PER_LOCK * 16;
+
+    explicit RegisterMap(RegisterMapLayout const& layout);
+
+    /// Read registers from addr, out.size() registers.
+    bool read(Table table, uint16_t addr, std::span<uint16_t> out) const;
+
+    /// Application write, changes are not marked.
+    bool write(Table table, uint16_t addr, std::span<uint16_t const> values);
+
+    /// Read count bits from addr into bytes packed LSB first, as in Modbus PDU.
+    bool read_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t> packed) const;
+
+    /// Application write of bits packed LSB first, changes are not marked.
+    bool write_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t const> packed);
+
+    /// Client write of registers, only holding registers are writable. Written registers are marked as changed.
+    bool client_write(Table table, uint16_t addr, std::span<uint16_t const> values);
+
+    /// Client write of bits, only coils are writable. Written coils are marked as changed.
+    bool client_write_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t const> packed);
+
+    /// Single register, address must be in table.
+    uint16_t reg(Table table, uint16_t addr) const;
+    void set_reg(Table table, uint16_t addr, uint16_t value);
+
+    /// Single bit, address must be in table.
+    bool bit(Table table, uint16_t addr) const;
+    void set_bit(Table table, uint16_t addr, bool value);
+
+    /// Any of count elements from addr is written by client since its change was taken.
+    bool is_changed(Table table, uint16_t addr, uint16_t count = 1) const;
+
+    /** Call fn(addr) for each element written by client since last call and clear its mark.
+     * Scans dirty bitmap word by word, clean words cost one load.
+     * @return Count of changed elements.
+     */
+    template <typename F>
+    std::size_t take_changed(Table table, F&& fn) {
+        auto& data = this->_tables[static_cast<std::size_t>(table)];
+        std::size_t taken = 0;
+        for (std::size_t w = 0; w < data.dirty_words; w++) {
+            if (0 == data.dirty[w].load(std::memory_order_relaxed)) {
+                continue;
+            }
+            uint32_t bits = data.dirty[w].exchange(0, std::memory_order_acquire);
+            while (bits) {
+                fn(static_cast<uint16_t>(data.range.start + w * 32 + std::countr_zero(bits)));
+                bits &= bits - 1;
+                taken += 1;
+            }
+        }
+        return taken;
+    }
+
+    /// Count of client writes, cheap check whether anything has changed.
+    uint32_t client_writes() const {
+        return this->_client_writes.load(std::memory_order_acquire);
+    }
+
+    TableRange range(Table table) const {
+        return this->_tables[static_cast<std::size_t>(table)].range;
+    }
+
+    RegisterMap(RegisterMap const&) = delete;
+    RegisterMap(RegisterMap&&) = delete;
+
+private:
+    struct TableData {
+        TableRange range{};
+        /// Registers, or bits packed 16 per word.
+        std::unique_ptr<uint16_t[]> words;
+        std::unique_ptr<std::atomic<uint32_t>[]> dirty;
+        std::size_t dirty_words = 0;
+        std::unique_ptr<sys::SpinLock[]> locks;
+        std::size_t per_lock = REGISTERS_PER_LOCK;
+    };
+
+    /// Locks stripes of element range in ascending order and unlocks them in reverse.
+    class RangeLock {
+    public:
+        RangeLock(TableData const& data, std::size_t offset, std::size_t count);
+        ~RangeLock();
+
+        RangeLock(RangeLock const&) = delete;
+
+    private:
+        sys::SpinLock* _locks;
+        std::size_t _first;
+        std::size_t _last;
+    };
+
+    std::array<TableData, TABLE_COUNT> _tables{};
+    std::atomic<uint32_t> _client_writes = 0;
+
+    /// Offset of range in table, std::nullopt if range is outside.
+    std::optional<std::size_t> _offset(Table table, uint16_t addr, std::size_t count) const;
+
+    void _write_registers(TableData& data, std::size_t offset, std::span<uint16_t const> values, bool is_client);
+    void _write_bits(TableData& data, std::size_t offset, uint16_t count, std::span<uint8_t const> packed,
+        bool is_client);
+    void _mark_changed(TableData& data, std::size_t offset, std::size_t count);
+};
+
+#if defined(CONFIG_MODBUS)
+/** Callbacks for Zephyr modbus server serving map: `.server = {.user_cb = modbus::server_callbacks(map)}`.
+ * Zephyr callbacks have no context, so all Zephyr modbus servers - RTU, ASCII and TCP - serve the same map.
+ * Zephyr accesses map register by register, so consistency over multi-register request
+ * is given only by block access of own transports.
+ */
+struct modbus_user_callbacks* server_callbacks(RegisterMap& map);
+#endif
+
+} // namespace modbus
+} // namespace mlplc
@@ -0,0 +1,192 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/sys.hpp>
+#include <mlplc/periph/serial.hpp>
+#include <mlplc/modbus/register_map.hpp>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <span>
+#include <cstdint>
+
+#if defined(CONFIG_UART_ASYNC_API)
+
+namespace mlplc {
+namespace modbus {
+
+using namespace std::chrono_literals;
+
+constexpr std::size_t POLL_MAX_ITEMS = 64;
+constexpr std::size_t POLL_MAX_SLAVES = 16;
+/// Limits of one read request by Modbus specification.
+constexpr uint16_t MAX_READ_REGISTERS = 125;
+constexpr uint16_t MAX_READ_BITS = 2000;
+
+/// Modbus RTU CRC, transmitted low byte first.
+constexpr uint16_t crc16(std::span<uint8_t const> data) {
+    uint16_t crc = 0xffff;
+    for (auto const byte : data) {
+        crc ^= byte;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+        }
+    }
+    return crc;
+}
+
+/// Registers polled periodically.
+struct PollItem {
+    uint8_t slave;
+    Table table;
+    uint16_t start;
+    uint16_t count;
+    std::chrono::milliseconds period;
+};
+
+enum class PollStatus : uint8_t {
+    /// Not polled yet.
+    None,
+    Ok,
+    Timeout,
+    /// Response with wrong CRC, slave, function or length.
+    BadResponse,
+    /// Slave answered with Modbus exception, see PollResult::exception.
+    Exception,
+};
+
+/// State of cached item. Values stay from the last successful poll when poll fails.
+struct PollResult {
+    PollStatus status = PollStatus::None;
+    /// Modbus exception code, for PollStatus::Exception.
+    uint8_t exception = 0;
+    /// Time of the last successful poll, see sys::now().
+    std::chrono::nanoseconds updated{0};
+    /// Count of publishes, may be used to detect new result.
+    uint32_t version = 0;
+};
+
+struct SlaveStats {
+    uint32_t requests = 0;
+    uint32_t responses = 0;
+    uint32_t timeouts = 0;
+    /// Bad responses and exceptions.
+    uint32_t errors = 0;
+    /// Latency from end of request transmission to end of response frame.
+    std::chrono::microseconds latency_last{0};
+    std::chrono::microseconds latency_min{0};
+    std::chrono::microseconds latency_max{0};
+    std::chrono::microseconds latency_avg{0};
+};
+
+struct RtuPollerConfig {
+    std::chrono::milliseconds response_timeout = 100ms;
+    /// Registers (bits) between two ranges which may be read needlessly to merge them into one request.
+    uint16_t max_gap = 0;
+};
+
+/** Modbus RTU master polling scheduler on periph::Serial.
+ * Items due at the same time are merged: ranges of one slave and table which overlap or are adjacent
+ * (up to max_gap apart) are read by one request, up to Modbus request limit. Request frames of a round are
+ * built in advance, and each request goes out right when Serial reports end of previous frame, i.e. after
+ * 3.5 character gap, so bus time is spent on data rather than turnarounds.
+ * Results are published into cache which is read without locks, see read().
+ */
+class RtuPoller {
+public:
+    /// Serial must use 8 data bits, its idle time is the RTU frame gap.
+    explicit RtuPoller(periph::Serial& serial, RtuPollerConfig const& config = {});
+
+    ~RtuPoller();
+
+    /// Add item before start(), returns item index for read().
+    std::size_t add(PollItem const& item);
+
+    void start(uint8_t priority = 0);
+
+    /// Stop polling, waits for current request.
+    void stop();
+
+    bool is_running() const {
+        return this->_is_running.load(std::memory_order_acquire);
+    }
+
+    /** Copy cached values of item, lock-free, never blocks. Bits are read as 0 or 1 per value.
+     * out may be shorter than item.
+     */
+    PollResult read(std::size_t item, std::span<uint16_t> out) const;
+
+    /// Statistics of slave, std::nullopt if slave is not polled.
+    std::optional<SlaveStats> slave_stats(uint8_t slave) const;
+
+    std::size_t size() const {
+        return this->_size;
+    }
+
+    RtuPoller(RtuPoller const&) = delete;
+    RtuPoller(RtuPoller&&) = delete;
+
+private:
+    static constexpr std::size_t THREAD_STACK_SIZE = 1536;
+    static constexpr uint32_t WAKE = BIT(0);
+
+    struct Item {
+        PollItem poll{};
+        uint8_t slave_slot = 0;
+        /// Double buffer of 2 * count values, the active half is selected by seq, as in sys::Snapshot.
+        std::unique_ptr<uint16_t[]> values;
+        std::atomic<uint32_t> seq = 0;
+        std::array<PollResult, 2> results{};
+        /// Used by poller thread only.
+        std::chrono::nanoseconds next_due{0};
+    };
+
+    struct Slave {
+        uint8_t address = 0;
+        sys::Snapshot<SlaveStats> stats;
+        /// Used by poller thread only.
+        SlaveStats acc{};
+        uint64_t latency_sum_us = 0;
+    };
+
+    /// Merged read request, covers items _order[first] .. _order[last - 1].
+    struct Request {
+        uint8_t first = 0;
+        uint8_t last = 0;
+        uint16_t start = 0;
+        uint16_t count = 0;
+        std::array<uint8_t, 8> frame{};
+    };
+
+    periph::Serial& _serial;
+    RtuPollerConfig _config;
+    sys::Mutex _mutex;
+    sys::Event _wake;
+
+    std::array<Item, POLL_MAX_ITEMS> _items{};
+    std::size_t _size = 0;
+    std::array<Slave, POLL_MAX_SLAVES> _slaves{};
+    std::size_t _slave_count = 0;
+
+    /// Scratch of poller thread: due items sorted by slave, table and address, and their requests.
+    std::array<uint8_t, POLL_MAX_ITEMS> _order{};
+    std::array<Request, POLL_MAX_ITEMS> _requests{};
+
+    std::unique_ptr<sys::Thread<>> _thread = nullptr;
+    std::atomic<bool> _is_running = false;
+
+    void _run();
+    std::size_t _plan(std::chrono::nanoseconds now);
+    void _transact(Request const& request);
+    void _publish(Item& item, PollStatus status, uint8_t exception, uint8_t const* data, std::size_t offset,
+        std::chrono::nanoseconds now);
+    void _account(Slave& slave, PollStatus status, std::chrono::nanoseconds latency);
+};
+
+} // namespace modbus
+} // namespace mlplc
+
+#endif // CONFIG_UART_ASYNC_API
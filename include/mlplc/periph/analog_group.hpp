@@ -0,0 +1,198 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/sys.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/kernel.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <span>
+#include <initializer_list>
+#include <cstdint>
+
+#if defined(CONFIG_ADC)
+
+namespace mlplc {
+namespace periph {
+
+using namespace std::chrono_literals;
+
+constexpr std::size_t ANALOG_GROUP_MAX_SIZE = 16;
+constexpr std::size_t ANALOG_GROUP_MAX_BLOCKS = 8;
+
+class AnalogGroup;
+
+/// Counters of continuous sampling of AnalogGroup.
+struct AnalogStats {
+    /// Blocks filled since start().
+    uint32_t blocks;
+    /// Filled blocks dropped because consumer did not take them in time.
+    uint32_t overruns;
+    /// Failed ADC sequences, their blocks are dropped too.
+    uint32_t errors;
+};
+
+/** Filled block of continuous sampling, view into buffer of AnalogGroup - nothing is copied.
+ * Block returns to sampler on destruction, so hold it only while processing.
+ */
+class AnalogBlock {
+public:
+    AnalogBlock(AnalogBlock&& other) noexcept;
+    AnalogBlock& operator= (AnalogBlock&& other) noexcept;
+    ~AnalogBlock();
+
+    /// Samples interleaved by channel: all channels of sampling 0, then of sampling 1 and so on.
+    std::span<int16_t const> samples() const {
+        return this->_samples;
+    }
+
+    /// Sample of group channel, see AnalogGroup::position().
+    int16_t at(std::size_t sampling, std::size_t channel) const;
+
+    std::size_t samplings() const {
+        return this->_samples.size() / this->_channels;
+    }
+
+    std::size_t channels() const {
+        return this->_channels;
+    }
+
+    /// Number of block since start(), gap in numbers means dropped blocks.
+    uint32_t sequence() const {
+        return this->_sequence;
+    }
+
+    /// Time of first sampling, see sys::now().
+    std::chrono::nanoseconds time() const {
+        return this->_time;
+    }
+
+    AnalogBlock(AnalogBlock const&) = delete;
+    AnalogBlock& operator= (AnalogBlock const&) = delete;
+
+private:
+    AnalogBlock(AnalogGroup* group, uint8_t idx);
+
+    AnalogGroup* _group = nullptr;
+    uint8_t _idx = 0;
+    std::span<int16_t const> _samples{};
+    std::size_t _channels = 1;
+    uint32_t _sequence = 0;
+    std::chrono::nanoseconds _time{0};
+
+    friend class AnalogGroup;
+};
+
+/** Channels of one ADC sampled together by ADC sequence, each sampling converts all channels.
+ * Channel settings - differential mode, gain, resolution, oversampling - come from devicetree.
+ * Continuous sampling fills ring of blocks allocated once in constructor. Sampler thread takes free block,
+ * fills it by one ADC sequence (DMA driven where ADC driver supports it) and queues it to consumer,
+ * while consumer processes previous block. If consumer is late and no block is free, the oldest
+ * queued block is refilled and counted as overrun.
+ */
+class AnalogGroup {
+public:
+    /** @param channels Analog channel indexes, see `mlplc_adcs` devicetree node.
+     * @param interval Sampling interval, e.g. 100us for 10 kHz per channel.
+     * @param block_samplings Samplings per block of continuous sampling.
+     * @param blocks Blocks in ring, at least 2: one is filled while other is processed.
+     */
+    AnalogGroup(std::span<uint8_t const> channels, std::chrono::microseconds interval,
+        std::size_t block_samplings, std::size_t blocks = 2);
+    AnalogGroup(std::initializer_list<uint8_t> channels, std::chrono::microseconds interval,
+        std::size_t block_samplings, std::size_t blocks = 2);
+
+    ~AnalogGroup();
+
+    /** Sample into caller buffer and block until done: one sampling for buffer of size() samples,
+     * N samplings for N * size(). Samples are interleaved by channel. Not allowed during continuous sampling.
+     */
+    void read(std::span<int16_t> samples);
+
+    /// Start continuous sampling in background thread.
+    void start(uint8_t priority = 0);
+
+    /// Stop continuous sampling, waits for current block. Blocks held by consumer stay valid.
+    void stop();
+
+    bool is_running() const {
+        return this->_is_running.load(std::memory_order_acquire);
+    }
+
+    /// Next filled block in order of sampling, std::nullopt on timeout.
+    std::optional<AnalogBlock> wait_block(sys::timeout_t timeout = sys::FOREVER);
+
+    AnalogStats stats() const {
+        return AnalogStats {
+            .blocks = this->_blocks_filled.load(std::memory_order_relaxed),
+            .overruns = this->_overruns.load(std::memory_order_relaxed),
+            .errors = this->_errors.load(std::memory_order_relaxed)};
+    }
+
+    std::size_t size() const {
+        return this->_size;
+    }
+
+    /// Position of group channel in sampling. ADC stores channels in order of ADC channel number.
+    std::size_t position(std::size_t channel) const {
+        return this->_position[channel];
+    }
+
+    /// Convert raw sample of channel to millivolts, using reference voltage from devicetree.
+    int32_t to_millivolts(std::size_t channel, int16_t raw) const;
+
+    AnalogGroup(AnalogGroup const&) = delete;
+    AnalogGroup(AnalogGroup&&) = delete;
+
+private:
+    static constexpr std::size_t THREAD_STACK_SIZE = 1024;
+
+    struct BlockInfo {
+        uint32_t sequence = 0;
+        std::chrono::nanoseconds time{0};
+    };
+
+    mutable sys::Mutex _mutex;
+    std::array<dtb::adc_spec_t, ANALOG_GROUP_MAX_SIZE> _specs{};
+    std::size_t _size = 0;
+    std::array<uint8_t, ANALOG_GROUP_MAX_SIZE> _position{};
+    struct device const* _dev = nullptr;
+    uint32_t _channel_mask = 0;
+    uint8_t _resolution = 0;
+    uint8_t _oversampling = 0;
+    std::chrono::microseconds _interval;
+    std::size_t _block_samplings;
+
+    std::unique_ptr<int16_t[]> _buffer;
+    std::array<BlockInfo, ANALOG_GROUP_MAX_BLOCKS> _block_info{};
+    std::array<uint8_t, ANALOG_GROUP_MAX_BLOCKS> _free_buf{};
+    std::array<uint8_t, ANALOG_GROUP_MAX_BLOCKS> _filled_buf{};
+    struct k_msgq _free{};
+    struct k_msgq _filled{};
+
+    std::unique_ptr<sys::Thread<>> _thread = nullptr;
+    std::atomic<bool> _is_running = false;
+    std::atomic<uint32_t> _blocks_filled = 0;
+    std::atomic<uint32_t> _overruns = 0;
+    std::atomic<uint32_t> _errors = 0;
+
+    int16_t* _block(uint8_t idx) const {
+        return this->_buffer.get() + idx * this->_block_samplings * this->_size;
+    }
+
+    int _read(int16_t* buffer, std::size_t samplings);
+    void _run();
+    void _release(uint8_t idx);
+
+    friend class AnalogBlock;
+};
+
+} // namespace periph
+} // namespace mlplc
+
+#endif // CONFIG_ADC
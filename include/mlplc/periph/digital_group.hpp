@@ -0,0 +1,120 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/sys.hpp>
+#include <mlplc/periph/digital_common.hpp>
+#include <mlplc/periph/digital_input.hpp>
+#include <mlplc/periph/digital_output.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/drivers/gpio.h>
+
+#include <array>
+#include <span>
+#include <initializer_list>
+#include <cstdint>
+
+namespace mlplc {
+namespace periph {
+
+/// Levels of group pins, bit N is level of N-th pin in group.
+using group_mask_t = uint32_t;
+
+constexpr std::size_t GROUP_MAX_SIZE = 32;
+
+namespace _private {
+
+/** Pins of group which are connected to one gpio controller.
+ * All of them are read/written by one port-wide driver call.
+ */
+struct GroupPort {
+    struct device const* dev = nullptr;
+    gpio_port_pins_t pins = 0;
+    gpio_port_pins_t active_low = 0;
+};
+
+class DigitalGroup {
+public:
+    std::size_t size() const {
+        return this->_size;
+    }
+
+    /// Count of gpio controllers, i.e. driver calls per group access.
+    std::size_t port_count() const {
+        return this->_port_count;
+    }
+
+protected:
+    DigitalGroup(std::span<uint8_t const> ports, gpio_flags_t flags);
+    ~DigitalGroup();
+
+    /// Convert raw port values to group levels.
+    group_mask_t _from_raw(std::array<gpio_port_value_t, GROUP_MAX_SIZE> const& raw) const;
+
+    mutable sys::Mutex _mutex;
+    std::array<dtb::gpio_spec_t, GROUP_MAX_SIZE> _specs{};
+    std::size_t _size = 0;
+    std::array<GroupPort, GROUP_MAX_SIZE> _ports{};
+    std::size_t _port_count = 0;
+    /// Index in _ports for each group pin.
+    std::array<uint8_t, GROUP_MAX_SIZE> _pin_port{};
+};
+
+} // namespace _private
+
+/** Set of digital inputs, read all at once.
+ * Pins sharing gpio controller are read by single gpio_port_get_raw() call,
+ * so scan cost depends on count of controllers, not pins.
+ */
+class DigitalInputGroup : public _private::DigitalGroup {
+public:
+    DigitalInputGroup(std::span<uint8_t const> ports, InputPull pull = InputPull::Up);
+    DigitalInputGroup(std::initializer_list<uint8_t> ports, InputPull pull = InputPull::Up);
+
+    group_mask_t levels() const;
+
+    Level level(std::size_t idx) const {
+        return level_from_num((this->levels() >> idx) & 1);
+    }
+
+    DigitalInputGroup(DigitalInputGroup const&) = delete;
+    DigitalInputGroup(DigitalInputGroup&&) = delete;
+};
+
+/** Set of digital outputs, written all at once.
+ * Pins sharing gpio controller are switched simultaneously by single gpio_port_set_masked_raw() call.
+ */
+class DigitalOutputGroup : public _private::DigitalGroup {
+public:
+    DigitalOutputGroup(std::span<uint8_t const> ports, OutputType type = OutputType::PushPull,
+        group_mask_t levels = 0);
+    DigitalOutputGroup(std::initializer_list<uint8_t> ports, OutputType type = OutputType::PushPull,
+        group_mask_t levels = 0);
+
+    /// Set levels of pins selected by mask, other pins are not changed.
+    void set_levels(group_mask_t mask, group_mask_t levels);
+
+    void set_levels(group_mask_t levels) {
+        this->set_levels(this->_all(), levels);
+    }
+
+    void set_level(std::size_t idx, Level level) {
+        this->set_levels(BIT(idx), level_to_int(level) << idx);
+    }
+
+    /// Last levels set.
+    group_mask_t levels() const;
+
+    DigitalOutputGroup(DigitalOutputGroup const&) = delete;
+    DigitalOutputGroup(DigitalOutputGroup&&) = delete;
+
+private:
+    group_mask_t _levels = 0;
+
+    group_mask_t _all() const {
+        return this->size() >= GROUP_MAX_SIZE ? ~group_mask_t(0) : BIT_MASK(this->size());
+    }
+};
+
+} // namespace periph
+} // namespace mlplc
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
 #include <mlplc/sys/sys.hpp>
 #include <mlplc/periph/digital_common.hpp>
 #include "dtb.hpp"
 
 #include <zephyr/device.h>
 
+#include <array>
 #include <memory>
 #include <optional>
 #include <chrono>
@@ -24,10 +26,56 @@ enum class InputPull {
 };
 
 struct LevelDuration {
-    std::chrono::milliseconds duration;
+    std::chrono::microseconds duration;
     Level level;
 };
 
+/// Level change with time since boot, see sys::now().
+struct Edge {
+    std::chrono::nanoseconds time;
+    Level level;
+};
+
+constexpr std::size_t EDGE_HISTORY_SIZE = 8;
+
+/// Recent edges of input, oldest first.
+struct EdgeHistory {
+    std::array<Edge, EDGE_HISTORY_SIZE> edges{};
+    std::size_t size = 0;
+    /// All edges since input creation, more than size means older edges are overwritten.
+    uint32_t total = 0;
+};
+
+class DigitalInput;
+
+/// Awaitable of sys::Task, see DigitalInput::edge().
+class EdgeAwaiter : sys::Listener, sys::Waiter {
+public:
+    EdgeAwaiter(DigitalInput const& input, std::optional<Level> level);
+    ~EdgeAwaiter();
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    void await_suspend(sys::Task::handle_t handle);
+
+    Level await_resume();
+
+    EdgeAwaiter(EdgeAwaiter const&) = delete;
+    EdgeAwaiter(EdgeAwaiter&&) = delete;
+
+private:
+    DigitalInput const& _input;
+    std::optional<Level> const _level_filter;
+    Level _level = Level::Low;
+    bool _is_woken = false;
+    sys::Scheduler* _scheduler = nullptr;
+
+    static bool _on_event(sys::Listener* listener, uint32_t value);
+    static void _on_poll(sys::Waiter* waiter);
+};
+
 class DigitalInput {
 public:
     DigitalInput(uint8_t port, InputPull pull = InputPull::Up, std::chrono::milliseconds debounce_duration = 100ms);
@@ -36,40 +84,112 @@ public:
         InputPull pull = InputPull::Up,
         std::chrono::milliseconds debounce_duration = 100ms);
 
+    /// Create from devicetree label resolved at compile time, unknown label is compile error.
+    template <dtb::Label L>
+    static DigitalInput of(InputPull pull = InputPull::Up, std::chrono::milliseconds debounce_duration = 100ms) {
+        return DigitalInput(dtb::gpio_idx_of<L>(), pull, debounce_duration);
+    }
+
+    /// Non-throwing construction, error is returned instead.
+    static expected<std::unique_ptr<DigitalInput>> new_unique(
+        uint8_t port,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 100ms);
+
+    static expected<std::shared_ptr<DigitalInput>> new_shared(
+        uint8_t port,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 100ms);
+
     ~DigitalInput();
 
     Level level() const;
 
-    void wait_level(Level level) const;
+    /** Block until pin has requested level.
+     * @return false on timeout.
+     */
+    bool wait_level(Level level, sys::timeout_t timeout = sys::FOREVER) const;
+
+    /** Block until next edge on pin.
+     * @return new level, std::nullopt on timeout.
+     */
+    std::optional<Level> wait_edge(sys::timeout_t timeout = sys::FOREVER) const;
 
     std::optional<Level> is_level_changed() const;
 
     LevelDuration level_duration() const;
 
+    /** Last EDGE_HISTORY_SIZE edges. Edges are timestamped by hardware cycle counter in GPIO ISR,
+     * for polled input - when level is read.
+     */
+    EdgeHistory edge_history() const;
+
+    /** Level filtered by background debounce engine, lock-free.
+     * @return std::nullopt while level differs from debounced one shorter than debounce duration.
+     */
     std::optional<Level> level_debounced() const;
 
-    void wait_level_debounced(Level level) const;
+    bool wait_level_debounced(Level level, sys::timeout_t timeout = sys::FOREVER) const;
 
     std::optional<Level> is_level_changed_debounced() const;
 
+    /// Debounce duration is rounded up to debounce tick (1ms) and limited to 255 ticks.
     void set_debounce_duration(std::chrono::milliseconds debounce_duration);
 
+    /// Edges are delivered by GPIO interrupt, otherwise pin is polled each GPIO_WAIT.
+    bool is_edge_irq() const {
+        return this->_is_edge_irq;
+    }
+
+    /** Awaitable of sys::Task: resumes on next edge, only on edge to given level if it is set.
+     * Result is new level.
+     */
+    EdgeAwaiter edge(std::optional<Level> level = std::nullopt) const {
+        return EdgeAwaiter(*this, level);
+    }
+
+    /** Subscribe to level changes, listener gets new level as value.
+     * Listener is called from ISR, or from thread which reads level of polled input.
+     */
+    void add_listener(sys::Listener* listener) const;
+    void remove_listener(sys::Listener* listener) const;
+
 private:
+    static constexpr uint32_t EVENT_EDGE = BIT(0);
+    static constexpr uint32_t EVENT_EDGE_DEBOUNCED = BIT(1);
+
+    struct EdgeCallback {
+        struct gpio_callback cb;
+        DigitalInput* self;
+    };
+
     mutable sys::Mutex _mutex;
     uint8_t _port;
     InputPull _pull;
     std::chrono::milliseconds _debounce_duration;
     dtb::gpio_spec_t _spec;
+    EdgeCallback _edge_callback{};
+    bool _is_edge_irq = false;
+    mutable sys::Event _events;
 
+    /// Protects level change state and listeners, which are used from ISR too.
+    mutable sys::SpinLock _state_lock;
     mutable Level _prev_level;
-    mutable Level _prev_level_debounced;
     mutable bool _is_level_changed = false;
-    mutable bool _is_level_debounced_changed = false;
-    mutable std::chrono::milliseconds _tl_level_change = 0ms;
+    mutable std::chrono::nanoseconds _tl_level_change{0};
+    mutable std::array<Edge, EDGE_HISTORY_SIZE> _edges{};
+    mutable uint32_t _edge_count = 0;
+    mutable sys::ListenerList _listeners;
+
+    DigitalInput(dtb::gpio_spec_t spec, uint8_t port, InputPull pull, std::chrono::milliseconds debounce_duration);
+    expected<void> _init();
 
     Level _level() const;
+    void _update_level(Level new_level, std::chrono::nanoseconds time) const;
+    bool _wait_edge_event(sys::Deadline const& deadline) const;
     LevelDuration _level_duration() const;
-    std::optional<Level> _level_debounced() const;
+
+    static void _on_edge(struct device const* port, struct gpio_callback* cb, gpio_port_pins_t pins);
 };
 
 } // namespace periph
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
 #include <mlplc/sys/sys.hpp>
 #include <mlplc/periph/digital_common.hpp>
 #include "dtb.hpp"
 
+#include <atomic>
 #include <expected>
 #include <memory>
 #include <optional>
@@ -16,46 +18,155 @@ namespace periph {
 
 using namespace std::chrono_literals;
 
+namespace _private {
+class PulseScheduler;
+}
+
 enum class OutputType {
     PushPull,
     OpenDrain,
 };
 
+enum class PulseMode {
+    /// Timer when pin has timer channel and pulse train fits it, software otherwise.
+    Auto,
+    /// Pulse edges are switched by software pulse scheduler.
+    Software,
+    /// Pulse train is generated by timer channel of pin, error if not possible.
+    Hardware,
+};
+
+class DigitalOutput;
+
+/// Awaitable of sys::Task, see DigitalOutput::pulse_done().
+class PulseDoneAwaiter : sys::Listener, sys::Waiter {
+public:
+    explicit PulseDoneAwaiter(DigitalOutput const& output);
+    ~PulseDoneAwaiter();
+
+    bool await_ready() const noexcept {
+        return false;
+    }
+
+    /// Does not suspend if pulse is not running.
+    bool await_suspend(sys::Task::handle_t handle);
+
+    void await_resume() const noexcept {}
+
+    PulseDoneAwaiter(PulseDoneAwaiter const&) = delete;
+    PulseDoneAwaiter(PulseDoneAwaiter&&) = delete;
+
+private:
+    DigitalOutput const& _output;
+    sys::Scheduler* _scheduler = nullptr;
+
+    static bool _on_event(sys::Listener* listener, uint32_t value);
+};
+
 class DigitalOutput {
 public:
     DigitalOutput(uint8_t port, OutputType type = OutputType::PushPull, Level level = Level::Low);
     DigitalOutput(std::string_view label, OutputType type = OutputType::PushPull, Level level = Level::Low);
 
+    /// Create from devicetree label resolved at compile time, unknown label is compile error.
+    template <dtb::Label L>
+    static DigitalOutput of(OutputType type = OutputType::PushPull, Level level = Level::Low) {
+        return DigitalOutput(dtb::gpio_idx_of<L>(), type, level);
+    }
+
+    /// Non-throwing construction, error is returned instead.
+    static expected<std::unique_ptr<DigitalOutput>> new_unique(
+        uint8_t port,
+        OutputType type = OutputType::PushPull,
+        Level level = Level::Low);
+
+    static expected<std::shared_ptr<DigitalOutput>> new_shared(
+        uint8_t port,
+        OutputType type = OutputType::PushPull,
+        Level level = Level::Low);
+
     ~DigitalOutput();
 
     void set_level(Level level);
 
-    void pulse_start(std::chrono::milliseconds t_low, std::chrono::milliseconds t_high,
-        std::optional<std::size_t> count = std::nullopt, Level first_level = Level::Low);
+    /** Start pulse generation in background, t_low and t_high must be positive.
+     * Software pulse edges are placed on kernel ticks, so edge jitter is up to one tick
+     * (CONFIG_SYS_CLOCK_TICKS_PER_SEC), while average frequency is exact.
+     * Timer generates only continuous pulse train - generic PWM API can't stop after exact
+     * count of periods, so counted train is always generated by software pulse scheduler.
+     */
+    void pulse_start(std::chrono::microseconds t_low, std::chrono::microseconds t_high,
+        std::optional<std::size_t> count = std::nullopt, Level first_level = Level::Low,
+        PulseMode mode = PulseMode::Auto);
 
     void pulse_stop();
 
-    void wait_pulse_end() const;
+    /** Block until pulse generation ends.
+     * @return false on timeout.
+     */
+    bool wait_pulse_end(sys::timeout_t timeout = sys::FOREVER) const;
 
     bool is_pulse_run() const;
 
+    /// Awaitable of sys::Task: resumes when pulse generation ends.
+    PulseDoneAwaiter pulse_done() const {
+        return PulseDoneAwaiter(*this);
+    }
+
+    /// Subscribe to pulse end. Listener is called from ISR.
+    void add_listener(sys::Listener* listener) const;
+    void remove_listener(sys::Listener* listener) const;
+
+    /// Pulse train is generated by timer.
+    bool is_pulse_hardware() const;
+
+    /// Count of failed level switches of software pulse generation.
+    uint32_t pulse_errors() const {
+        return this->_pulse_errors.load(std::memory_order_relaxed);
+    }
+
 private:
+    static constexpr uint32_t EVENT_PULSE_END = BIT(0);
+
     mutable sys::Mutex _mutex;
     uint8_t _port;
     OutputType _type;
     Level _desired_level;
     dtb::gpio_spec_t _spec;
+    gpio_flags_t _flags = 0;
+    mutable sys::Event _events;
+    bool _is_pulse_hw = false;
+
+    // Pulse state is owned by pulse scheduler and protected by its lock.
     std::optional<Level> _pulse_state;
-    std::chrono::milliseconds _tl_pulse_sw = 0ms;
+    int64_t _pulse_deadline = 0;
+    /// Pulse start in ticks and time of next edge since start.
+    int64_t _pulse_origin = 0;
+    std::chrono::microseconds _pulse_elapsed = 0us;
+    std::size_t _pulse_queue_idx = 0;
     Level _pulse_first_level = Level::Low;
     std::size_t _pulse_remain = 0;
     bool _is_pulse_continuous = false;
-    std::chrono::milliseconds _pulse_t_low = 0ms;
-    std::chrono::milliseconds _pulse_t_high = 0ms;
+    std::chrono::microseconds _pulse_t_low = 0us;
+    std::chrono::microseconds _pulse_t_high = 0us;
+    mutable sys::ListenerList _listeners;
+    std::atomic<uint32_t> _pulse_errors = 0;
+
+    DigitalOutput(dtb::gpio_spec_t spec, uint8_t port, OutputType type, Level level);
+    expected<void> _init();
 
     void _set_level(Level level) noexcept;
+    /// Single attempt, safe in ISR.
+    void _pulse_set_level(Level level) noexcept;
+
+    bool _pulse_start_hw(std::chrono::microseconds t_low, std::chrono::microseconds t_high, Level first_level);
+    void _pulse_stop_hw() noexcept;
+
+    /// Switch pulse level on deadline. Returns true if pulse continues.
+    bool _pulse_switch() noexcept;
 
-    void _handle(std::chrono::milliseconds now) noexcept;
+    friend class _private::PulseScheduler;
+    friend class PulseDoneAwaiter;
 };
 
 } // namespace periph
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
+#include <mlplc/sys/sys.hpp>
+#include <mlplc/periph/digital_common.hpp>
+#include <mlplc/periph/digital_input.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/device.h>
+
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <string_view>
+
+namespace mlplc {
+namespace periph {
+
+using namespace std::chrono_literals;
+
+enum class MeasureSource {
+    /// Timer input capture, `pwms` timer channel of gpio node. Cycle-exact, no CPU load per edge.
+    Capture,
+    /// Both edges are timestamped by hardware cycle counter in GPIO ISR.
+    Interrupt,
+};
+
+/// Signal parameters averaged over measurement window.
+struct Measurement {
+    float frequency;
+    std::chrono::nanoseconds period;
+    /// High time to period ratio, 0..1.
+    float duty;
+    /// Periods in window.
+    uint32_t periods;
+    /// End of window, time since boot, see sys::now().
+    std::chrono::nanoseconds time;
+};
+
+/** Frequency, period and duty cycle of signal on gpio.
+ * Whole periods (rising edge to rising edge) are accumulated in ISR until their sum reaches window,
+ * then averages are published in sys::Snapshot, so results are read without locks.
+ */
+class FrequencyInput {
+public:
+    /** @param window Averaging window, at least one period is always averaged.
+     * @param timeout Without complete period for this time signal is treated as absent.
+     */
+    FrequencyInput(
+        uint8_t port,
+        std::chrono::milliseconds window = 100ms,
+        std::chrono::milliseconds timeout = 1000ms,
+        InputPull pull = InputPull::None);
+    FrequencyInput(
+        std::string_view label,
+        std::chrono::milliseconds window = 100ms,
+        std::chrono::milliseconds timeout = 1000ms,
+        InputPull pull = InputPull::None);
+
+    /// Create from devicetree label resolved at compile time, unknown label is compile error.
+    template <dtb::Label L>
+    static FrequencyInput of(
+        std::chrono::milliseconds window = 100ms,
+        std::chrono::milliseconds timeout = 1000ms,
+        InputPull pull = InputPull::None)
+    {
+        return FrequencyInput(dtb::gpio_idx_of<L>(), window, timeout, pull);
+    }
+
+    /// Non-throwing construction, error is returned instead.
+    static expected<std::unique_ptr<FrequencyInput>> new_unique(
+        uint8_t port,
+        std::chrono::milliseconds window = 100ms,
+        std::chrono::milliseconds timeout = 1000ms,
+        InputPull pull = InputPull::None);
+
+    static expected<std::shared_ptr<FrequencyInput>> new_shared(
+        uint8_t port,
+        std::chrono::milliseconds window = 100ms,
+        std::chrono::milliseconds timeout = 1000ms,
+        InputPull pull = InputPull::None);
+
+    ~FrequencyInput();
+
+    /// Last published measurement, std::nullopt if signal is absent. Lock-free, ISR-safe.
+    std::optional<Measurement> measurement() const;
+
+    /// Frequency in Hz, 0 if signal is absent. Lock-free.
+    float frequency() const;
+
+    /// Count of published measurements, may be used to detect new one.
+    uint32_t version() const {
+        return this->_measurement.version();
+    }
+
+    MeasureSource source() const {
+        return this->_source;
+    }
+
+    FrequencyInput(FrequencyInput const&) = delete;
+    FrequencyInput(FrequencyInput&&) = delete;
+
+private:
+    struct EdgeCallback {
+        struct gpio_callback cb;
+        FrequencyInput* self;
+    };
+
+    /// Accumulated periods of current window in source clock cycles, used from ISR only.
+    struct Window {
+        uint64_t period_sum = 0;
+        uint64_t high_sum = 0;
+        uint32_t periods = 0;
+    };
+
+    uint8_t _port;
+    std::chrono::milliseconds _window;
+    std::chrono::milliseconds _timeout;
+    InputPull _pull;
+    dtb::gpio_spec_t _spec;
+    MeasureSource _source = MeasureSource::Interrupt;
+    EdgeCallback _edge_callback{};
+    uint64_t _cycles_per_sec = 0;
+    uint64_t _window_cycles = 0;
+    uint64_t _timeout_cycles = 0;
+    Window _acc{};
+    sys::Snapshot<Measurement> _measurement;
+
+    /// Edge timestamps of interrupt source.
+    uint64_t _t_rise = 0;
+    uint64_t _t_fall = 0;
+    bool _is_rise_seen = false;
+
+#if defined(CONFIG_PWM_CAPTURE) && defined(CONFIG_PINCTRL)
+    std::optional<dtb::GpioPwm> _pwm = std::nullopt;
+    /// Time of last capture, detects signal loss.
+    std::chrono::nanoseconds _t_capture{0};
+#endif
+
+    FrequencyInput(
+        dtb::gpio_spec_t spec,
+        uint8_t port,
+        std::chrono::milliseconds window,
+        std::chrono::milliseconds timeout,
+        InputPull pull);
+    expected<void> _init();
+    expected<void> _init_capture();
+    expected<void> _init_interrupt();
+
+    void _add_period(uint64_t period, uint64_t high);
+
+    static void _on_edge(struct device const* port, struct gpio_callback* cb, gpio_port_pins_t pins);
+#if defined(CONFIG_PWM_CAPTURE) && defined(CONFIG_PINCTRL)
+    static void _on_capture(struct device const* dev, uint32_t channel, uint32_t period_cycles,
+        uint32_t pulse_cycles, int status, void* user_data);
+#endif
+};
+
+} // namespace periph
+} // namespace mlplc
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/sys.hpp>
+#include <mlplc/periph/digital_common.hpp>
+#include <mlplc/periph/digital_group.hpp>
+
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <span>
+#include <initializer_list>
+#include <cstdint>
+
+namespace mlplc {
+namespace periph {
+
+/** PLC process image of digital inputs and outputs.
+ * Once per cycle all inputs are captured into input image and output image is written to pins.
+ * Logic reads consistent input snapshot without locks and driver calls, and writes only output image.
+ * Cycle may be run by background thread - start(), or manually by read_inputs()/write_outputs()
+ * from a single thread.
+ */
+class ProcessImage {
+public:
+    struct Inputs {
+        group_mask_t levels = 0;
+        /// Number of capture, incremented on each read_inputs().
+        uint32_t cycle = 0;
+    };
+
+    ProcessImage(std::span<uint8_t const> inputs, std::span<uint8_t const> outputs,
+        InputPull pull = InputPull::Up, OutputType type = OutputType::PushPull);
+    ProcessImage(std::initializer_list<uint8_t> inputs, std::initializer_list<uint8_t> outputs,
+        InputPull pull = InputPull::Up, OutputType type = OutputType::PushPull);
+
+    ~ProcessImage();
+
+    /// Capture all inputs into input image.
+    void read_inputs();
+
+    /// Write output image to pins.
+    void write_outputs();
+
+    /// Run cycle in background thread with given period.
+    void start(std::chrono::microseconds period, uint8_t priority = 0);
+
+    void stop();
+
+    Inputs inputs() const {
+        return this->_inputs.read();
+    }
+
+    Level input(std::size_t idx) const {
+        return level_from_num((this->inputs().levels >> idx) & 1);
+    }
+
+    /// Set output image bits selected by mask, pins are written at the end of cycle.
+    void set_outputs(group_mask_t mask, group_mask_t levels);
+
+    void set_output(std::size_t idx, Level level) {
+        this->set_outputs(BIT(idx), level_to_int(level) << idx);
+    }
+
+    group_mask_t outputs() const {
+        return this->_outputs.load(std::memory_order_acquire);
+    }
+
+    ProcessImage(ProcessImage const&) = delete;
+    ProcessImage(ProcessImage&&) = delete;
+
+private:
+    static constexpr std::size_t THREAD_STACK_SIZE = 1024;
+
+    DigitalInputGroup _input_group;
+    DigitalOutputGroup _output_group;
+    sys::Snapshot<Inputs> _inputs;
+    std::atomic<group_mask_t> _outputs = 0;
+
+    sys::Mutex _mutex;
+    std::unique_ptr<sys::CyclicTask> _task = nullptr;
+};
+
+} // namespace periph
+} // namespace mlplc
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
+#include <mlplc/sys/sys.hpp>
+#include <mlplc/periph/digital_common.hpp>
+#include <mlplc/periph/digital_input.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/device.h>
+
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <string_view>
+
+namespace mlplc {
+namespace periph {
+
+using namespace std::chrono_literals;
+
+enum class CountMode {
+    /// Interrupt if pin has interrupt, else Polled.
+    Auto,
+    /// Debounced level is sampled by background debounce engine each 1ms, up to few hundreds Hz.
+    Polled,
+    /// Each edge is counted by GPIO ISR, up to few kHz.
+    Interrupt,
+};
+
+enum class CountEdge {
+    Rising,
+    Falling,
+    Both,
+};
+
+class PulseCounter {
+public:
+    /** @param edge Counted edge.
+     * @param debounce_duration Used in polled mode only.
+     */
+    PulseCounter(
+        uint8_t port,
+        CountMode mode = CountMode::Auto,
+        CountEdge edge = CountEdge::Rising,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 10ms);
+    PulseCounter(
+        std::string_view label,
+        CountMode mode = CountMode::Auto,
+        CountEdge edge = CountEdge::Rising,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 10ms);
+
+    /// Create from devicetree label resolved at compile time, unknown label is compile error.
+    template <dtb::Label L>
+    static PulseCounter of(
+        CountMode mode = CountMode::Auto,
+        CountEdge edge = CountEdge::Rising,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 10ms)
+    {
+        return PulseCounter(dtb::gpio_idx_of<L>(), mode, edge, pull, debounce_duration);
+    }
+
+    /// Non-throwing construction, error is returned instead.
+    static expected<std::unique_ptr<PulseCounter>> new_unique(
+        uint8_t port,
+        CountMode mode = CountMode::Auto,
+        CountEdge edge = CountEdge::Rising,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 10ms);
+
+    static expected<std::shared_ptr<PulseCounter>> new_shared(
+        uint8_t port,
+        CountMode mode = CountMode::Auto,
+        CountEdge edge = CountEdge::Rising,
+        InputPull pull = InputPull::Up,
+        std::chrono::milliseconds debounce_duration = 10ms);
+
+    ~PulseCounter();
+
+    /// Pulses since creation or last reset, wraps at 2^32.
+    uint32_t count() const;
+
+    /** Return count and restart it from zero in one atomic operation,
+     * so pulse is neither lost nor counted twice between read and reset.
+     */
+    uint32_t reset();
+
+    /** Pulse rate in Hz, averaged from previous call of rate() (or creation) until now.
+     * Caller sets averaging window by call period.
+     */
+    float rate();
+
+    /// Resolved mode, never CountMode::Auto.
+    CountMode mode() const {
+        return this->_mode;
+    }
+
+    CountEdge edge() const {
+        return this->_edge;
+    }
+
+    PulseCounter(PulseCounter const&) = delete;
+    PulseCounter(PulseCounter&&) = delete;
+
+private:
+    struct EdgeCallback {
+        struct gpio_callback cb;
+        PulseCounter* self;
+    };
+
+    struct DebounceListener : sys::Listener {
+        PulseCounter* self;
+    };
+
+    sys::Mutex _mutex;
+    uint8_t _port;
+    CountMode _mode;
+    CountEdge _edge;
+    InputPull _pull;
+    std::chrono::milliseconds _debounce_duration;
+    dtb::gpio_spec_t _spec;
+    EdgeCallback _edge_callback{};
+    DebounceListener _debounce_listener{};
+
+    /// Pulses since creation, never reset. Count is difference with _base.
+    std::atomic<uint32_t> _pulses = 0;
+    std::atomic<uint32_t> _base = 0;
+    uint32_t _rate_pulses = 0;
+    std::chrono::nanoseconds _rate_time{0};
+
+    PulseCounter(
+        dtb::gpio_spec_t spec,
+        uint8_t port,
+        CountMode mode,
+        CountEdge edge,
+        InputPull pull,
+        std::chrono::milliseconds debounce_duration);
+    expected<void> _init();
+    expected<void> _init_interrupt();
+    expected<void> _init_polled();
+
+    uint32_t _total() const;
+    bool _is_counted(Level level) const;
+
+    static void _on_edge(struct device const* port, struct gpio_callback* cb, gpio_port_pins_t pins);
+    static bool _on_debounced(sys::Listener* listener, uint32_t value);
+};
+
+} // namespace periph
+} // namespace mlplc
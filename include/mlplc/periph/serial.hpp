@@ -0,0 +1,247 @@
+#pragma once
+
+#include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
+#include <mlplc/sys/sys.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/uart.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <chrono>
+#include <span>
+#include <string_view>
+#include <cstdint>
+
+#if defined(CONFIG_UART_ASYNC_API)
+
+namespace mlplc {
+namespace periph {
+
+using namespace std::chrono_literals;
+
+constexpr std::size_t SERIAL_MAX_FRAMES = 16;
+
+enum class Parity : uint8_t {
+    None,
+    Odd,
+    Even,
+};
+
+enum class StopBits : uint8_t {
+    One,
+    Two,
+};
+
+struct SerialConfig {
+    uint32_t baudrate = 115200;
+    /// 8 or 9. 9-bit words are read and written as uint16_t, requires CONFIG_UART_WIDE_DATA.
+    uint8_t data_bits = 8;
+    Parity parity = Parity::None;
+    StopBits stop_bits = StopBits::One;
+    /// RX ring is rx_chunks chunks of rx_chunk words, both powers of 2. Driver fills one chunk while next is queued.
+    uint16_t rx_chunk = 64;
+    uint8_t rx_chunks = 4;
+    /// TX ring size in words, power of 2.
+    uint16_t tx_size = 256;
+    /// Line idle time which ends frame, 0 is 3.5 character times - Modbus RTU t3.5, but at least 1750us.
+    std::chrono::microseconds idle = 0us;
+};
+
+/// Counters of Serial.
+struct SerialStats {
+    /// Frames ended by idle line.
+    uint32_t frames;
+    /// Reception stops because RX ring was full, incoming data is lost until reader frees a chunk.
+    uint32_t overruns;
+    /// Line errors: overrun, parity, framing, noise, break.
+    uint32_t errors;
+};
+
+/** Received data in RX ring, nothing is copied. Data wrapping around ring end is two spans.
+ * View stays valid until its data is consumed by Serial::consume().
+ */
+template <typename T>
+struct RingView {
+    std::span<T const> first{};
+    std::span<T const> second{};
+
+    std::size_t size() const {
+        return this->first.size() + this->second.size();
+    }
+
+    bool empty() const {
+        return 0 == this->size();
+    }
+
+    T operator[] (std::size_t i) const {
+        return i < this->first.size() ? this->first[i] : this->second[i - this->first.size()];
+    }
+
+    /// First count words.
+    RingView prefix(std::size_t count) const {
+        if (count <= this->first.size()) {
+            return RingView{this->first.first(count), {}};
+        }
+        return RingView{this->first, this->second.first(std::min(count - this->first.size(), this->second.size()))};
+    }
+
+    /// Copy into contiguous buffer, e.g. to parse frame. Returns count of copied words.
+    std::size_t copy_to(std::span<T> out) const {
+        std::size_t const n1 = std::min(out.size(), this->first.size());
+        std::copy_n(this->first.begin(), n1, out.begin());
+        std::size_t const n2 = std::min(out.size() - n1, this->second.size());
+        std::copy_n(this->second.begin(), n2, out.begin() + n1);
+        return n1 + n2;
+    }
+};
+
+/** UART port on Zephyr async API - DMA moves data, CPU handles only buffer events.
+ * Driver receives into chunks of RX ring, chunk is handed to driver again once reader consumed its data.
+ * Received data is read in place by peek() / wait() / wait_frame() and released by consume().
+ * Line idle for `idle` time ends frame, so frame protocols like Modbus RTU get whole frames without timers.
+ * Written data is copied to TX ring and sent by DMA in background.
+ * One reader thread and any number of writer threads are supported.
+ */
+class Serial {
+public:
+    explicit Serial(uint8_t idx, SerialConfig const& config = {});
+    Serial(std::string_view label, SerialConfig const& config = {});
+
+    /// Create from devicetree label resolved at compile time, unknown label is compile error.
+    template <dtb::Label L>
+    static Serial of(SerialConfig const& config = {}) {
+        return Serial(dtb::serial_idx_of<L>(), config);
+    }
+
+    /// Non-throwing construction, error is returned instead.
+    static expected<std::unique_ptr<Serial>> new_unique(uint8_t idx, SerialConfig const& config = {});
+    static expected<std::shared_ptr<Serial>> new_shared(uint8_t idx, SerialConfig const& config = {});
+
+    ~Serial();
+
+    /** All received and not consumed data. T is uint8_t for 8-bit words and uint16_t for 9-bit ones.
+     * Lock-free, never blocks.
+     */
+    template <typename T = uint8_t>
+    RingView<T> peek() const;
+
+    /// Wait for received data, empty view on timeout.
+    template <typename T = uint8_t>
+    RingView<T> wait(sys::timeout_t timeout = sys::FOREVER);
+
+    /** Wait for end of next frame, view contains data from the oldest not consumed word up to frame end.
+     * @return std::nullopt on timeout.
+     */
+    template <typename T = uint8_t>
+    std::optional<RingView<T>> wait_frame(sys::timeout_t timeout = sys::FOREVER);
+
+    /// Release count words read by peek(), return their chunks to driver.
+    void consume(std::size_t count);
+
+    /// Drop all received data, e.g. garbage before request.
+    void clear();
+
+    /** Queue data for sending, never blocks.
+     * @return Count of queued words, less than data size if TX ring is full.
+     */
+    template <typename T = uint8_t>
+    std::size_t write(std::span<T const> data);
+
+    /// Queue all data, waiting for free space in TX ring. Returns false on timeout, part of data may be queued.
+    template <typename T = uint8_t>
+    bool write_all(std::span<T const> data, sys::timeout_t timeout = sys::FOREVER);
+
+    /// Wait until all queued data is sent. Returns false on timeout.
+    bool flush(sys::timeout_t timeout = sys::FOREVER);
+
+    SerialStats stats() const {
+        return SerialStats {
+            .frames = this->_frames.load(std::memory_order_relaxed),
+            .overruns = this->_overruns.load(std::memory_order_relaxed),
+            .errors = this->_errors.load(std::memory_order_relaxed)};
+    }
+
+    SerialConfig const& config() const {
+        return this->_config;
+    }
+
+    /// Time of one character on line: start bit, data, parity and stop bits.
+    std::chrono::microseconds char_time() const {
+        return this->_char_time;
+    }
+
+    Serial(Serial const&) = delete;
+    Serial(Serial&&) = delete;
+
+private:
+    enum EventBits : uint32_t {
+        RxData = BIT(0),
+        RxFrame = BIT(1),
+        TxDone = BIT(2),
+        RxDisabled = BIT(3),
+    };
+
+    SerialConfig _config;
+    dtb::serial_spec_t _spec;
+    std::size_t _word_size = 1;
+    std::chrono::microseconds _char_time{0};
+    std::chrono::microseconds _idle{0};
+    mutable sys::SpinLock _lock;
+    sys::Event _events;
+
+    /// Positions are counts of words since start, ring index is position modulo ring size.
+    std::unique_ptr<uint8_t[]> _rx_buf;
+    uint32_t _rx_size = 0;
+    std::atomic<uint32_t> _rx_head = 0;
+    std::atomic<uint32_t> _rx_tail = 0;
+    /// End of RX ring region handed to driver.
+    uint32_t _rx_given = 0;
+    bool _is_rx_buf_requested = false;
+    bool _is_rx_enabled = false;
+    bool _is_closing = false;
+    /// Frame end positions, FIFO.
+    std::array<uint32_t, SERIAL_MAX_FRAMES> _frame_ends{};
+    uint32_t _frame_head = 0;
+    uint32_t _frame_tail = 0;
+    /// Detects frame ending exactly at chunk end - driver reports no idle event then.
+    struct k_timer _idle_timer{};
+
+    std::unique_ptr<uint8_t[]> _tx_buf;
+    uint32_t _tx_size = 0;
+    uint32_t _tx_head = 0;
+    uint32_t _tx_tail = 0;
+    uint32_t _tx_in_flight = 0;
+
+    std::atomic<uint32_t> _frames = 0;
+    std::atomic<uint32_t> _overruns = 0;
+    std::atomic<uint32_t> _errors = 0;
+
+    Serial(dtb::serial_spec_t spec, SerialConfig const& config);
+    expected<void> _init();
+
+    template <typename T>
+    RingView<T> _view(uint32_t from, uint32_t to) const;
+
+    std::span<uint8_t> _next_rx_region();
+    int _rx_enable();
+    void _give_rx_buf();
+    void _on_rx(std::size_t words);
+    void _on_rx_disabled();
+    void _push_frame_end();
+    int _tx_start();
+    void _on_tx_done(std::optional<std::size_t> words);
+
+    static void _on_event(struct device const* dev, struct uart_event* event, void* user_data);
+    static void _on_idle_timer(struct k_timer* timer);
+};
+
+} // namespace periph
+} // namespace mlplc
+
+#endif // CONFIG_UART_ASYNC_API
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/** 64-bit hardware cycle counter, ISR-safe.
+ * Where timer has no 64-bit counter (e.g. Cortex-M SysTick) 32-bit counter is extended by software,
+ * a background timer reads it often enough to not miss a wrap.
+ */
+uint64_t cycles();
+
+/// Time since boot with hardware cycle resolution. ISR-safe.
+static inline std::chrono::nanoseconds now() {
+    return std::chrono::nanoseconds(k_cyc_to_ns_floor64(cycles()));
+}
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <mlplc/sys/event.hpp>
+#include <mlplc/sys/spinlock.hpp>
+
+#include <zephyr/kernel.h>
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+class Scheduler;
+
+/** Suspended coroutine waiting for scheduler: in ready queue or in timer queue.
+ * Node is embedded into awaiter, so waiting does not allocate.
+ */
+struct Waiter {
+    std::coroutine_handle<> handle = nullptr;
+    Waiter* ready_next = nullptr;
+    Waiter* timer_next = nullptr;
+    int64_t deadline = 0;
+    bool is_sleeping = false;
+    /// Called by scheduler on deadline instead of resume, e.g. to poll the awaited source.
+    void (*on_deadline)(Waiter* waiter) = nullptr;
+};
+
+/** Coroutine of cooperative control logic, run by Scheduler.
+ * Task may be spawned on scheduler or awaited from another task.
+ */
+class Task {
+public:
+    struct promise_type;
+    using handle_t = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        std::coroutine_handle<> await_suspend(handle_t handle) noexcept;
+
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        Scheduler* scheduler = nullptr;
+        /// Awaiting task, resumed on completion.
+        std::coroutine_handle<> continuation = nullptr;
+        /// Spawned task is owned by scheduler.
+        bool is_detached = false;
+        promise_type* prev = nullptr;
+        promise_type* next = nullptr;
+        Waiter waiter{};
+#if defined(CONFIG_CPP_EXCEPTIONS)
+        std::exception_ptr error = nullptr;
+#endif
+
+        Task get_return_object() {
+            return Task(handle_t::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        FinalAwaiter final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+#if defined(CONFIG_CPP_EXCEPTIONS)
+            this->error = std::current_exception();
+#endif
+        }
+    };
+
+    Task(Task&& other) noexcept :
+        _handle(std::exchange(other._handle, nullptr))
+    {}
+
+    ~Task() {
+        if (this->_handle) {
+            this->_handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return !this->_handle || this->_handle.done();
+    }
+
+    std::coroutine_handle<> await_suspend(handle_t caller) noexcept {
+        this->_handle.promise().scheduler = caller.promise().scheduler;
+        this->_handle.promise().continuation = caller;
+        return this->_handle;
+    }
+
+    /// Exception of awaited task is rethrown to awaiting one.
+    void await_resume() {
+#if defined(CONFIG_CPP_EXCEPTIONS)
+        if (this->_handle && this->_handle.promise().error) {
+            std::rethrow_exception(this->_handle.promise().error);
+        }
+#endif
+    }
+
+    Task(Task const&) = delete;
+    Task& operator= (Task const&) = delete;
+
+private:
+    explicit Task(handle_t handle) :
+        _handle(handle)
+    {}
+
+    handle_t _handle = nullptr;
+
+    friend class Scheduler;
+};
+
+/** Single-threaded scheduler of coroutine tasks.
+ * All tasks share stack of thread which calls run(), so hundreds of small
+ * state machines cost their coroutine frames only.
+ * Suspended tasks are resumed by event sources (GPIO interrupts, pulse end) through
+ * ISR-safe wake() and by deadlines of one k_timer.
+ */
+class Scheduler {
+public:
+    Scheduler();
+    ~Scheduler();
+
+    /// Add task, it is started by run(). Call before run() or from tasks of this scheduler.
+    void spawn(Task task);
+
+    /// Run tasks in calling thread until all of them are finished or stop() is called.
+    void run();
+
+    /// Make run() return after currently running task suspends. May be called from any thread.
+    void stop();
+
+    std::size_t task_count() const {
+        return this->_task_count;
+    }
+
+    /// Count of spawned tasks finished by unhandled exception.
+    uint32_t errors() const {
+        return this->_errors;
+    }
+
+    /// Queue waiter for resume. ISR-safe.
+    void wake(Waiter* waiter);
+
+    /// Resume waiter (or call its on_deadline) at absolute tick deadline. Scheduler thread only.
+    void sleep_until(Waiter* waiter, int64_t deadline);
+
+    /// Remove waiter from timer queue if it is there. Scheduler thread only.
+    void cancel_sleep(Waiter* waiter);
+
+    Scheduler(Scheduler const&) = delete;
+    Scheduler(Scheduler&&) = delete;
+
+private:
+    static constexpr uint32_t EVENT_READY = BIT(0);
+    static constexpr uint32_t EVENT_TIMER = BIT(1);
+    static constexpr uint32_t EVENT_STOP = BIT(2);
+
+    /// Protects ready queue, which is filled from ISR too.
+    SpinLock _lock;
+    Waiter* _ready_head = nullptr;
+    Waiter* _ready_tail = nullptr;
+    /// Deadline ordered, touched by scheduler thread only.
+    Waiter* _timers = nullptr;
+    struct k_timer _timer{};
+    Event _events;
+
+    Task::promise_type* _tasks = nullptr;
+    std::size_t _task_count = 0;
+    uint32_t _errors = 0;
+
+    Waiter* _pop_ready();
+    void _expire_timers();
+    void _rearm_timer();
+    void _on_task_done(Task::handle_t handle);
+
+    static void _on_timer(struct k_timer* timer);
+
+    friend struct Task::FinalAwaiter;
+};
+
+/// Awaitable of sys::delay().
+class DelayAwaiter : Waiter {
+public:
+    explicit DelayAwaiter(std::chrono::microseconds duration) :
+        _duration(duration)
+    {}
+
+    ~DelayAwaiter() {
+        if (this->_scheduler) {
+            this->_scheduler->cancel_sleep(this);
+        }
+    }
+
+    bool await_ready() const noexcept {
+        return this->_duration.count() <= 0;
+    }
+
+    void await_suspend(Task::handle_t handle) {
+        this->handle = handle;
+        this->_scheduler = handle.promise().scheduler;
+        this->_scheduler->sleep_until(this, k_uptime_ticks() + k_us_to_ticks_ceil64(this->_duration.count()));
+    }
+
+    void await_resume() const noexcept {}
+
+    DelayAwaiter(DelayAwaiter const&) = delete;
+    DelayAwaiter(DelayAwaiter&&) = delete;
+
+private:
+    std::chrono::microseconds const _duration;
+    Scheduler* _scheduler = nullptr;
+};
+
+/// Suspend task for duration, other tasks of scheduler run meanwhile.
+inline DelayAwaiter delay(std::chrono::microseconds duration) {
+    return DelayAwaiter(duration);
+}
+
+} // namespace sys
+} // namespace mlplc
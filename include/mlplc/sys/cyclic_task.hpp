@@ -0,0 +1,101 @@
+#pragma once
+
+#include <mlplc/sys/mutex.hpp>
+#include <mlplc/sys/thread.hpp>
+#include <mlplc/sys/snapshot.hpp>
+
+#include <zephyr/kernel.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string_view>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+using namespace std::chrono_literals;
+
+/// Execution statistics of cyclic task.
+struct CycleStats {
+    static constexpr std::size_t JITTER_BINS = 32;
+    static constexpr std::chrono::microseconds JITTER_BIN_WIDTH = 10us;
+
+    uint32_t cycles = 0;
+    /// Cycles which did not finish before next cycle start.
+    uint32_t overruns = 0;
+    std::chrono::microseconds exec_last = 0us;
+    std::chrono::microseconds exec_min = std::chrono::microseconds::max();
+    std::chrono::microseconds exec_max = 0us;
+    /// Jitter is delay of cycle start from its deadline.
+    std::chrono::microseconds jitter_min = std::chrono::microseconds::max();
+    std::chrono::microseconds jitter_max = 0us;
+    /// Jitter histogram, bin N counts jitter in [N, N + 1) * JITTER_BIN_WIDTH, last bin counts the rest.
+    std::array<uint32_t, JITTER_BINS> jitter_histogram{};
+
+    /** Jitter which is not exceeded by given share of cycles, with JITTER_BIN_WIDTH resolution.
+     * @param percentile 0..100.
+     */
+    std::chrono::microseconds jitter_percentile(float percentile) const;
+};
+
+/** Deterministic PLC scan cycle in own thread: read inputs, user logic, write outputs.
+ * Cycles are started at absolute deadlines, so period does not drift and does not
+ * stretch with execution time. Overrunned cycles are counted and missed deadlines are skipped.
+ */
+class CyclicTask {
+public:
+    CyclicTask(
+        std::string_view name,
+        std::chrono::microseconds period,
+        std::function<void()> logic,
+        std::size_t stack_size,
+        uint8_t priority,
+        std::function<void()> read_inputs = nullptr,
+        std::function<void()> write_outputs = nullptr);
+
+    ~CyclicTask();
+
+    void start();
+
+    /** Finish current cycle and stop.
+     * Called from task callbacks it returns at once, task thread ends after current cycle.
+     */
+    void stop();
+
+    /// Consistent copy of statistics, does not block the task.
+    CycleStats stats() const {
+        return this->_stats.read();
+    }
+
+    /// Called from task thread after overrunned cycle.
+    void set_on_overrun(std::function<void(CycleStats const&)> on_overrun);
+
+    std::chrono::microseconds period() const {
+        return this->_period;
+    }
+
+    CyclicTask(CyclicTask const&) = delete;
+    CyclicTask(CyclicTask&&) = delete;
+
+private:
+    std::chrono::microseconds const _period;
+    std::function<void()> const _logic;
+    std::function<void()> const _read_inputs;
+    std::function<void()> const _write_outputs;
+
+    Mutex _mutex;
+    std::function<void(CycleStats const&)> _on_overrun = nullptr;
+    std::atomic<bool> _is_running = false;
+    bool _is_started = false;
+    Snapshot<CycleStats> _stats;
+    std::atomic<k_tid_t> _tid = nullptr;
+    Thread<> _thread;
+
+    void _run();
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <mlplc/sys/timeout.hpp>
+
+#include <zephyr/kernel.h>
+
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/** C++ wrapper for zephyr event object - set of 32 event bits.
+ * post() and clear() may be called from ISR.
+ */
+class Event {
+public:
+    Event() {
+        k_event_init(&this->_k_event);
+    }
+
+    void post(uint32_t events) {
+        k_event_post(&this->_k_event, events);
+    }
+
+    void clear(uint32_t events) {
+        k_event_clear(&this->_k_event, events);
+    }
+
+    /// Wait any of events. Returns matched events, 0 on timeout.
+    uint32_t wait(uint32_t events, Deadline const& deadline) {
+        return k_event_wait(&this->_k_event, events, false, deadline.k_timeout());
+    }
+
+    Event(Event const&) = delete;
+    Event(Event&&) = delete;
+
+private:
+    struct k_event _k_event{};
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/** Intrusive node of event source notification list, e.g. input edge or pulse end.
+ * Callback is called from ISR with lock of the source held, so it must be short and ISR-safe.
+ * Callback returns false to unsubscribe.
+ */
+struct Listener {
+    bool (*on_event)(Listener* listener, uint32_t value) = nullptr;
+    Listener* next = nullptr;
+};
+
+/// Singly linked list of listeners, guarded by lock of its owner. Does not allocate.
+class ListenerList {
+public:
+    void add(Listener* listener) {
+        listener->next = this->_head;
+        this->_head = listener;
+    }
+
+    /// Remove listener if it is in list.
+    void remove(Listener* listener) {
+        for (Listener** p = &this->_head; *p; p = &(*p)->next) {
+            if (*p == listener) {
+                *p = listener->next;
+                listener->next = nullptr;
+                return;
+            }
+        }
+    }
+
+    void notify(uint32_t value) {
+        Listener** p = &this->_head;
+        while (*p) {
+            Listener* const listener = *p;
+            if (listener->on_event(listener, value)) {
+                p = &listener->next;
+            } else {
+                *p = listener->next;
+                listener->next = nullptr;
+            }
+        }
+    }
+
+    bool empty() const {
+        return nullptr == this->_head;
+    }
+
+private:
+    Listener* _head = nullptr;
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "macro.hpp"
+#include <mlplc/exception.hpp>
+#include <mlplc/sys/event.hpp>
+#include <mlplc/sys/listener.hpp>
+#include <mlplc/sys/timeout.hpp>
+#include <mlplc/periph/digital_common.hpp>
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/// Sources of Poller, bit N is source returned by N-th add().
+using poll_mask_t = uint32_t;
+
+/** Wait for any of several event sources without busy polling.
+ * Source is any object with add_listener()/remove_listener(): DigitalInput (level change,
+ * value is new level), DigitalOutput (pulse end), Thread and StaticThread (completion).
+ * Sources post bits of one k_event from their ISR/thread, and wait() blocks on it.
+ * Fired bits are kept until returned by wait(), so nothing is lost between waits.
+ * DigitalInput without edge interrupt reports changes only when read, so wait() reads it each POLL_INTERVAL.
+ */
+class Poller {
+public:
+    static constexpr std::size_t MAX_SOURCES = 32;
+    /// Read interval of sources without edge interrupt.
+    static constexpr std::chrono::milliseconds POLL_INTERVAL = periph::GPIO_WAIT;
+
+    Poller() = default;
+
+    /// Unsubscribe from all sources. Sources must outlive poller.
+    ~Poller();
+
+    /** Subscribe to source.
+     * @param value Fire only on events with this value, e.g. level_to_int(Level::High) for rising edge.
+     * @return Source bit index in poll_mask_t.
+     */
+    template<typename Source>
+    std::size_t add(Source const& source, std::optional<uint32_t> value = std::nullopt) {
+        ASSERT(this->_size < MAX_SOURCES, ExceptionType::NoMemory, "Too many poll sources");
+        std::size_t const idx = this->_size;
+        Entry& entry = this->_entries[idx];
+        entry.on_event = Poller::_on_event;
+        entry.poller = this;
+        entry.bit = BIT(idx);
+        entry.value = value;
+        entry.source = &source;
+        entry.unsubscribe = [](void const* source, Listener* listener) {
+            static_cast<Source const*>(source)->remove_listener(listener);
+        };
+        if constexpr (requires { source.is_edge_irq(); }) {
+            if (!source.is_edge_irq()) {
+                entry.poll = [](void const* source) {
+                    static_cast<Source const*>(source)->level();
+                };
+                this->_polled += 1;
+            }
+        }
+        this->_size += 1;
+        source.add_listener(&entry);
+        return idx;
+    }
+
+    /// Wait until any source fires. Returns fired sources and forgets them, 0 on timeout.
+    poll_mask_t wait(timeout_t timeout = FOREVER);
+
+    std::size_t size() const {
+        return this->_size;
+    }
+
+    Poller(Poller const&) = delete;
+    Poller(Poller&&) = delete;
+
+private:
+    struct Entry : Listener {
+        Poller* poller = nullptr;
+        poll_mask_t bit = 0;
+        std::optional<uint32_t> value = std::nullopt;
+        void const* source = nullptr;
+        void (*unsubscribe)(void const* source, Listener* listener) = nullptr;
+        /// Reads source without edge interrupt, its listeners are notified on change.
+        void (*poll)(void const* source) = nullptr;
+    };
+
+    Event _events;
+    std::array<Entry, MAX_SOURCES> _entries{};
+    std::size_t _size = 0;
+    std::size_t _polled = 0;
+
+    static bool _on_event(Listener* listener, uint32_t value);
+};
+
+/** Wait until any of sources fires.
+ * @return Mask of fired sources in argument order, 0 on timeout.
+ */
+template<typename... Sources>
+poll_mask_t wait_any(timeout_t timeout, Sources const&... sources) {
+    Poller poller;
+    (poller.add(sources), ...);
+    return poller.wait(timeout);
+}
+
+} // namespace sys
+} // namespace mlplc
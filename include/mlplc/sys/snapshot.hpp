@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+namespace mlplc {
+namespace sys {
+
+/** Value with single writer and many lock-free readers, readers always get consistent copy.
+ * Writer fills inactive copy of double buffer and publishes it by sequence increment.
+ * Reader copies active buffer and retries only if writer published during the copy.
+ * Nobody waits for preempted thread, so it is safe between threads of any priority and ISR.
+ */
+template <typename T>
+class Snapshot {
+    static_assert(std::is_trivially_copyable_v<T>, "Snapshot value must be trivially copyable");
+
+public:
+    Snapshot() = default;
+
+    explicit Snapshot(T const& value) {
+        this->_buf[0] = value;
+        this->_buf[1] = value;
+    }
+
+    void write(T const& value) {
+        uint32_t const seq = this->_seq.load(std::memory_order_relaxed);
+        this->_buf[(seq + 1) & 1] = value;
+        this->_seq.store(seq + 1, std::memory_order_release);
+    }
+
+    T read() const {
+        while (1) {
+            uint32_t const seq = this->_seq.load(std::memory_order_acquire);
+            T const value = this->_buf[seq & 1];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (this->_seq.load(std::memory_order_relaxed) == seq) {
+                return value;
+            }
+        }
+    }
+
+    /// Count of writes, may be used to detect new value.
+    uint32_t version() const {
+        return this->_seq.load(std::memory_order_acquire);
+    }
+
+    Snapshot(Snapshot const&) = delete;
+    Snapshot(Snapshot&&) = delete;
+
+private:
+    std::atomic<uint32_t> _seq = 0;
+    T _buf[2]{};
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+namespace mlplc {
+namespace sys {
+
+/** C++ wrapper for zephyr spinlock. Usable from ISR, compatible with std::lock_guard.
+ * Lock key is stored inside object, it is touched only by current lock holder.
+ */
+class SpinLock {
+public:
+    SpinLock() = default;
+
+    void lock() {
+        this->_key = k_spin_lock(&this->_k_spinlock);
+    }
+
+    void unlock() {
+        k_spin_unlock(&this->_k_spinlock, this->_key);
+    }
+
+    SpinLock(SpinLock const&) = delete;
+    SpinLock(SpinLock&&) = delete;
+
+private:
+    struct k_spinlock _k_spinlock{};
+    k_spinlock_key_t _key{};
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include <array>
+#include <optional>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/// Usage of one size class of thread stack pool.
+struct StackClassStats {
+    std::size_t stack_size = 0;
+    uint32_t count = 0;
+    uint32_t used = 0;
+    /// High-water mark of used stacks.
+    uint32_t max_used = 0;
+};
+
+#if defined(CONFIG_MLPLC_STACK_POOL)
+
+constexpr std::size_t STACK_POOL_CLASS_COUNT = 3;
+
+/// Thread stack taken from pool.
+struct PooledStack {
+    k_thread_stack_t* stack = nullptr;
+    /// Usable size, size of stack class.
+    std::size_t size = 0;
+};
+
+/** Take stack from smallest size class which fits and has free stack. Takes constant time.
+ * Returns nullopt if size is bigger than biggest class or all fitting classes are exhausted.
+ */
+std::optional<PooledStack> stack_pool_alloc(std::size_t size);
+
+/// Return stack taken by stack_pool_alloc().
+void stack_pool_free(k_thread_stack_t* stack);
+
+std::array<StackClassStats, STACK_POOL_CLASS_COUNT> stack_pool_stats();
+
+#endif // CONFIG_MLPLC_STACK_POOL
+
+} // namespace sys
+} // namespace mlplc
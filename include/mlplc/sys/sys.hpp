@@ -1,7 +1,18 @@
 #pragma once
 
 #include <mlplc/sys/mutex.hpp>
+#include <mlplc/sys/spinlock.hpp>
+#include <mlplc/sys/event.hpp>
+#include <mlplc/sys/timeout.hpp>
+#include <mlplc/sys/clock.hpp>
+#include <mlplc/sys/snapshot.hpp>
 #include <mlplc/sys/thread.hpp>
+#include <mlplc/sys/cyclic_task.hpp>
+#include <mlplc/sys/thread_pool.hpp>
+#include <mlplc/sys/stack_pool.hpp>
+#include <mlplc/sys/listener.hpp>
+#include <mlplc/sys/coro.hpp>
+#include <mlplc/sys/poller.hpp>
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log_ctrl.h>
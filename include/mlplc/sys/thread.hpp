@@ -2,7 +2,11 @@
 
 #include "macro.hpp"
 #include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
 #include <mlplc/sys/mutex.hpp>
+#include <mlplc/sys/spinlock.hpp>
+#include <mlplc/sys/listener.hpp>
+#include <mlplc/sys/stack_pool.hpp>
 
 #include <zephyr/kernel.h>
 #include <zephyr/sys/printk.h>
@@ -11,9 +15,15 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <new>
 #include <expected>
 #include <optional>
 #include <tuple>
+#include <array>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 
 namespace mlplc {
 namespace sys {
@@ -24,15 +34,56 @@ namespace {
 
 namespace _private {
 
+constexpr uint8_t THREAD_STATE_DEAD = 0x08;
+
+/// Set zephyr thread name without heap allocation, name is truncated to CONFIG_THREAD_MAX_NAME_LEN.
+inline int set_thread_name(struct k_thread* thread, std::string_view name) {
+#if defined(CONFIG_THREAD_NAME)
+    std::array<char, CONFIG_THREAD_MAX_NAME_LEN> name_c{};
+    std::size_t const len = std::min(name.size(), name_c.size() - 1);
+    std::copy_n(name.begin(), len, name_c.begin());
+    return k_thread_name_set(thread, name_c.data());
+#else
+    return 0;
+#endif
+}
+
+/// Constructor tag: members only, kernel objects are created by separate fallible call.
+struct NoInit {};
+
+/// Thread completion notification. Listener added after completion is notified at once.
+class DoneSignal {
+public:
+    void add(Listener* listener) {
+        std::lock_guard<SpinLock> lock(this->_lock);
+        if (!this->_is_done || listener->on_event(listener, 0)) {
+            this->_listeners.add(listener);
+        }
+    }
+
+    void remove(Listener* listener) {
+        std::lock_guard<SpinLock> lock(this->_lock);
+        this->_listeners.remove(listener);
+    }
+
+    void signal() {
+        std::lock_guard<SpinLock> lock(this->_lock);
+        this->_is_done = true;
+        this->_listeners.notify(0);
+    }
+
+private:
+    SpinLock _lock;
+    ListenerList _listeners;
+    bool _is_done = false;
+};
+
 }
 
 template<typename... Args> static void thread_entry(void* p1, void* p2, void* p3);
 
 template<typename... Args>
 class Thread {
-private:
-    static constexpr uint8_t THREAD_STATE_DEAD = 0x08;
-
 public:
     Thread(
         std::string_view name,
@@ -41,22 +92,9 @@ public:
         std::size_t stack_size,
         uint8_t priority,
         Args&&... args) :
-        _name(name),
-        _func(func),
-        _args(args...),
-        _stack_size(stack_size),
-        _priority(priority)
+        Thread(_private::NoInit{}, name, func, stack_size, priority, std::forward<Args>(args)...)
     {
-        this->_thread = std::shared_ptr<struct k_thread>((struct k_thread*)k_object_alloc(K_OBJ_THREAD),
-            [](struct k_thread* th){k_object_free(th);});
-        ASSERT(this->_thread, ExceptionType::NoMemory, "Fail to allocate thread object");
-
-        k_tid_t id = k_thread_create(this->_thread.get(), stack, this->_stack_size,
-            thread_entry<Args...>, this, NULL, NULL, this->_priority, 0, K_FOREVER);
-        ASSERT(id, ExceptionType::Unknown, "Fail to create thread");
-
-        std::string name_c(name);
-        CCALL(k_thread_name_set(this->_thread.get(), name_c.c_str()));
+        unwrap(this->_create(stack));
     }
 
     Thread(
@@ -65,26 +103,40 @@ public:
         std::size_t stack_size,
         uint8_t priority,
         Args&&... args) :
-        _name(name),
-        _func(func),
-        _args(args...),
-        _stack_size(stack_size),
-        _priority(priority)
+        Thread(_private::NoInit{}, name, func, stack_size, priority, std::forward<Args>(args)...)
     {
-        this->_stack = std::shared_ptr<k_thread_stack_t>(k_thread_stack_alloc(this->_stack_size, 0),
-            [](k_thread_stack_t* stack){k_thread_stack_free(stack);});
-        ASSERT(this->_stack, ExceptionType::NoMemory);
-
-        this->_thread = std::shared_ptr<struct k_thread>((struct k_thread*)k_object_alloc(K_OBJ_THREAD),
-            [](struct k_thread* th){printk("Destroy thread object..\n"); k_object_free(th);});
-        ASSERT(this->_thread, ExceptionType::NoMemory, "Fail to allocate thread object");
+        unwrap(this->_alloc_stack());
+        unwrap(this->_create(this->_stack.get()));
+    }
 
-        k_tid_t id = k_thread_create(this->_thread.get(), this->_stack.get(), this->_stack_size,
-            thread_entry<Args...>, this, NULL, NULL, this->_priority, 0, K_FOREVER);
-        ASSERT(id, ExceptionType::Unknown, "Fail to create thread");
+    /// Non-throwing construction of thread with dynamic stack, error is returned instead.
+    static expected<std::unique_ptr<Thread>> new_unique(
+        std::string_view name,
+        std::function<void(Args...)> func,
+        std::size_t stack_size,
+        uint8_t priority,
+        Args&&... args)
+    {
+        std::unique_ptr<Thread> thread(new (std::nothrow) Thread(
+            _private::NoInit{}, name, func, stack_size, priority, std::forward<Args>(args)...));
+        TRY_ASSERT(thread, ExceptionType::NoMemory);
+        TRY(thread->_alloc_stack());
+        TRY(thread->_create(thread->_stack.get()));
+        return thread;
+    }
 
-        std::string name_c(name);
-        CCALL(k_thread_name_set(this->_thread.get(), name_c.c_str()));
+    static expected<std::shared_ptr<Thread>> new_shared(
+        std::string_view name,
+        std::function<void(Args...)> func,
+        std::size_t stack_size,
+        uint8_t priority,
+        Args&&... args)
+    {
+        auto thread = Thread::new_unique(name, func, stack_size, priority, std::forward<Args>(args)...);
+        if (!thread) {
+            return std::unexpected(thread.error());
+        }
+        return std::shared_ptr<Thread>(std::move(*thread));
     }
 
     ~Thread() {
@@ -118,7 +170,7 @@ public:
 
     bool is_finished() const {
         std::lock_guard<Mutex> lock(this->_mutex);
-        return this->_thread->base.thread_state & THREAD_STATE_DEAD;
+        return this->_thread->base.thread_state & _private::THREAD_STATE_DEAD;
     }
 
     std::optional<std::string> error() {
@@ -141,6 +193,17 @@ public:
         return this->_name;
     }
 
+    /** Subscribe to completion of thread function. Listener is called from the finishing thread,
+     * thread must still be joined before destroying.
+     */
+    void add_listener(Listener* listener) const {
+        this->_done.add(listener);
+    }
+
+    void remove_listener(Listener* listener) const {
+        this->_done.remove(listener);
+    }
+
     Thread(Thread&) = delete;
     Thread(Thread const&) = delete;
     Thread(Thread&&) = delete;
@@ -150,13 +213,62 @@ private:
 
     std::string _name;
     std::function<void(Args...)> const _func;
-    std::tuple<Args...> const _args;
+    std::tuple<Args...> _args;
     std::size_t const _stack_size;
     uint8_t _priority;
 
     std::shared_ptr<struct k_thread> _thread = nullptr;
     std::shared_ptr<k_thread_stack_t> _stack = nullptr;
     std::optional<std::string> _error = std::nullopt;
+    mutable _private::DoneSignal _done;
+
+    Thread(
+        _private::NoInit,
+        std::string_view name,
+        std::function<void(Args...)> func,
+        std::size_t stack_size,
+        uint8_t priority,
+        Args&&... args) :
+        _name(name),
+        _func(func),
+        _args(std::forward<Args>(args)...),
+        _stack_size(stack_size),
+        _priority(priority)
+    {}
+
+    expected<void> _alloc_stack() {
+#if defined(CONFIG_MLPLC_STACK_POOL)
+        if (auto pooled = stack_pool_alloc(this->_stack_size)) {
+            this->_stack = std::shared_ptr<k_thread_stack_t>(pooled->stack,
+                [](k_thread_stack_t* stack){stack_pool_free(stack);});
+        }
+#endif
+        if (!this->_stack) {
+            this->_stack = std::shared_ptr<k_thread_stack_t>(k_thread_stack_alloc(this->_stack_size, 0),
+                [](k_thread_stack_t* stack){k_thread_stack_free(stack);});
+        }
+        TRY_ASSERT(this->_stack, ExceptionType::NoMemory);
+        return {};
+    }
+
+    expected<void> _create(k_thread_stack_t* stack) {
+        auto thread = std::shared_ptr<struct k_thread>((struct k_thread*)k_object_alloc(K_OBJ_THREAD),
+            [](struct k_thread* th){printk("Destroy thread object..\n"); k_object_free(th);});
+        TRY_ASSERT(thread, ExceptionType::NoMemory);
+
+        k_tid_t id = k_thread_create(thread.get(), stack, this->_stack_size,
+            thread_entry<Args...>, this, NULL, NULL, this->_priority, 0, K_FOREVER);
+        TRY_ASSERT(id, ExceptionType::Unknown);
+
+        int const rc = _private::set_thread_name(thread.get(), this->_name);
+        if (0 != rc) {
+            k_thread_abort(thread.get());
+            return std::unexpected(Error{exception_type_from_c_code(rc), rc});
+        }
+        // Set only for created thread, so destructor checks only threads which could run.
+        this->_thread = thread;
+        return {};
+    }
 
     friend void thread_entry<Args...>(void*, void*, void*);
 };
@@ -164,11 +276,149 @@ private:
 template<typename... Args>
 static void thread_entry(void* p1, void* p2, void* p3) {
     Thread<Args...>* _this = reinterpret_cast<Thread<Args...>*>(p1);
+#if defined(CONFIG_CPP_EXCEPTIONS)
     try {
-        _this->_func(std::get<Args>(_this->_args)...);
+        std::apply(_this->_func, std::move(_this->_args));
     } catch (std::exception const& ex) {
         _this->_error = std::string(ex.what());
     }
+#else
+    std::apply(_this->_func, std::move(_this->_args));
+#endif
+    _this->_done.signal();
+}
+
+template<std::size_t StackSize, typename F, typename... Args>
+static void static_thread_entry(void* p1, void* p2, void* p3);
+
+/** Thread with stack, thread object, callable and its arguments stored in place.
+ * Callable and arguments are perfectly forwarded and may be move-only,
+ * so thread owning peripheral objects needs no heap when object itself is static.
+ * Use make_thread<StackSize>() to deduce callable and argument types.
+ */
+template<std::size_t StackSize, typename F, typename... Args>
+class StaticThread {
+public:
+    template<typename Func, typename... FArgs>
+    StaticThread(std::string_view name, uint8_t priority, Func&& func, FArgs&&... args) :
+        _func(std::forward<Func>(func)),
+        _args(std::forward<FArgs>(args)...)
+    {
+        k_tid_t id = k_thread_create(&this->_thread, this->_stack, K_KERNEL_STACK_SIZEOF(this->_stack),
+            static_thread_entry<StackSize, F, Args...>, this, NULL, NULL, priority, 0, K_FOREVER);
+        ASSERT(id, ExceptionType::Unknown, "Fail to create thread");
+        CCALL(_private::set_thread_name(&this->_thread, name));
+    }
+
+    ~StaticThread() {
+        if (this->_is_started) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wterminate"
+            ASSERT(this->is_finished(), ExceptionType::DestroyingRunningThread, this->name());
+#pragma GCC diagnostic pop
+        } else {
+            k_thread_abort(&this->_thread);
+        }
+    }
+
+    void start() {
+        std::lock_guard<Mutex> lock(this->_mutex);
+        if (!this->_is_started) {
+            this->_is_started = true;
+            k_thread_start(&this->_thread);
+        }
+    }
+
+    void join() {
+        CCALL(k_thread_join(&this->_thread, K_FOREVER));
+    }
+
+    /// @warning See Thread::abort().
+    void abort() {
+        std::lock_guard<Mutex> lock(this->_mutex);
+        k_thread_abort(&this->_thread);
+    }
+
+    bool is_finished() const {
+        return this->_thread.base.thread_state & _private::THREAD_STATE_DEAD;
+    }
+
+    std::optional<std::string> error() {
+        std::lock_guard<Mutex> lock(this->_mutex);
+        return this->_error;
+    }
+
+    std::size_t stack_usage() const {
+        std::size_t usage = 0;
+        CCALL(k_thread_stack_space_get(&this->_thread, &usage));
+        return usage;
+    }
+
+    static constexpr std::size_t stack_size() {
+        return StackSize;
+    }
+
+    std::string_view name() const {
+#if defined(CONFIG_THREAD_NAME)
+        return k_thread_name_get(const_cast<struct k_thread*>(&this->_thread));
+#else
+        return "";
+#endif
+    }
+
+    /** Subscribe to completion of thread function. Listener is called from the finishing thread,
+     * thread must still be joined before destroying.
+     */
+    void add_listener(Listener* listener) const {
+        this->_done.add(listener);
+    }
+
+    void remove_listener(Listener* listener) const {
+        this->_done.remove(listener);
+    }
+
+    StaticThread(StaticThread const&) = delete;
+    StaticThread(StaticThread&&) = delete;
+
+private:
+    mutable Mutex _mutex;
+    F _func;
+    std::tuple<Args...> _args;
+    bool _is_started = false;
+    std::optional<std::string> _error = std::nullopt;
+    mutable _private::DoneSignal _done;
+
+    struct k_thread _thread{};
+    K_KERNEL_STACK_MEMBER(_stack, StackSize);
+
+    friend void static_thread_entry<StackSize, F, Args...>(void*, void*, void*);
+};
+
+template<std::size_t StackSize, typename F, typename... Args>
+static void static_thread_entry(void* p1, void* p2, void* p3) {
+    auto* _this = reinterpret_cast<StaticThread<StackSize, F, Args...>*>(p1);
+#if defined(CONFIG_CPP_EXCEPTIONS)
+    try {
+        std::apply(std::move(_this->_func), std::move(_this->_args));
+    } catch (std::exception const& ex) {
+        std::lock_guard<Mutex> lock(_this->_mutex);
+        _this->_error = std::string(ex.what());
+    }
+#else
+    std::apply(std::move(_this->_func), std::move(_this->_args));
+#endif
+    _this->_done.signal();
+}
+
+/** Create StaticThread, callable and arguments are decay-copied or moved into it.
+ * Object is not movable and is returned by guaranteed copy elision.
+ */
+template<std::size_t StackSize, typename F, typename... Args>
+StaticThread<StackSize, std::decay_t<F>, std::decay_t<Args>...> make_thread(
+    std::string_view name, uint8_t priority, F&& func, Args&&... args)
+{
+    return StaticThread<StackSize, std::decay_t<F>, std::decay_t<Args>...>(
+        name, priority, std::forward<F>(func), std::forward<Args>(args)...);
 }
 
 } // namespace sys
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <mlplc/sys/event.hpp>
+#include <mlplc/sys/thread.hpp>
+#include <mlplc/sys/timeout.hpp>
+
+#include <zephyr/kernel.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+class ThreadPool;
+
+namespace _private {
+
+/// Task slot of thread pool, shared by worker which runs the task and task handle.
+struct PoolSlot {
+    std::move_only_function<void()> func = nullptr;
+    std::optional<std::string> error = std::nullopt;
+    Event done;
+    /// Worker and handle references, slot is returned to pool when both are dropped.
+    std::atomic<uint8_t> refs = 0;
+};
+
+} // namespace _private
+
+/** Completion handle of task submitted to thread pool.
+ * Dropping handle does not cancel the task. Handle must not outlive its pool.
+ */
+class TaskHandle {
+public:
+    TaskHandle() = default;
+
+    TaskHandle(TaskHandle&& other) noexcept :
+        _pool(std::exchange(other._pool, nullptr)),
+        _idx(other._idx)
+    {}
+
+    TaskHandle& operator= (TaskHandle&& other) noexcept;
+
+    ~TaskHandle();
+
+    /// Wait task completion. Returns false on timeout.
+    bool wait(timeout_t timeout = FOREVER);
+
+    bool is_done();
+
+    /// Exception message if task has thrown. Valid after completion.
+    std::optional<std::string> error() const;
+
+    TaskHandle(TaskHandle const&) = delete;
+    TaskHandle& operator= (TaskHandle const&) = delete;
+
+private:
+    TaskHandle(ThreadPool* pool, uint8_t idx) :
+        _pool(pool),
+        _idx(idx)
+    {}
+
+    ThreadPool* _pool = nullptr;
+    uint8_t _idx = 0;
+
+    friend class ThreadPool;
+};
+
+/** Fixed set of worker threads executing submitted tasks in FIFO order.
+ * Threads, stacks and task slots are allocated once in constructor,
+ * so submit() costs one queue push instead of thread creation and RAM usage is bounded.
+ */
+class ThreadPool {
+public:
+    static constexpr std::size_t MAX_TASKS = 254;
+
+    /**
+     * @param workers Count of worker threads.
+     * @param max_tasks Count of task slots, i.e. tasks queued or running or with alive handle.
+     */
+    ThreadPool(
+        std::string_view name,
+        std::size_t workers,
+        std::size_t max_tasks,
+        std::size_t stack_size,
+        uint8_t priority);
+
+    /// Runs already submitted tasks and joins workers.
+    ~ThreadPool();
+
+    /** Queue task for execution.
+     * Blocks while all task slots are busy, returns nullopt on timeout.
+     */
+    std::optional<TaskHandle> submit(std::move_only_function<void()> func, timeout_t timeout = FOREVER);
+
+    std::size_t workers() const {
+        return this->_workers.size();
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+
+private:
+    static constexpr uint8_t STOP_IDX = 0xff;
+    static constexpr uint32_t EVENT_DONE = BIT(0);
+
+    std::unique_ptr<_private::PoolSlot[]> _slots;
+    std::unique_ptr<uint8_t[]> _free_buf;
+    std::unique_ptr<uint8_t[]> _pending_buf;
+    struct k_msgq _free{};
+    struct k_msgq _pending{};
+    std::vector<std::unique_ptr<Thread<>>> _workers{};
+
+    void _run();
+    void _stop_workers();
+    void _unref(uint8_t idx);
+
+    friend class TaskHandle;
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+
+#include <chrono>
+#include <optional>
+#include <cstdint>
+
+namespace mlplc {
+namespace sys {
+
+/// Wait timeout, std::nullopt means wait forever.
+using timeout_t = std::optional<std::chrono::microseconds>;
+
+constexpr timeout_t FOREVER = std::nullopt;
+
+/** Absolute point in time in kernel ticks, made from relative timeout.
+ * Allows to wait in loop without timeout stretching on each iteration.
+ */
+class Deadline {
+public:
+    explicit Deadline(timeout_t timeout) {
+        if (timeout) {
+            this->_ticks = k_uptime_ticks() + k_us_to_ticks_ceil64(timeout->count());
+        }
+    }
+
+    k_timeout_t k_timeout() const {
+        if (this->_ticks) {
+            return K_TIMEOUT_ABS_TICKS(*this->_ticks);
+        }
+        return K_FOREVER;
+    }
+
+    bool is_expired() const {
+        return this->_ticks && k_uptime_ticks() >= *this->_ticks;
+    }
+
+    timeout_t remain() const {
+        if (!this->_ticks) {
+            return FOREVER;
+        }
+        int64_t const remain_ticks = *this->_ticks - k_uptime_ticks();
+        return std::chrono::microseconds(remain_ticks > 0 ? k_ticks_to_us_floor64(remain_ticks) : 0);
+    }
+
+private:
+    std::optional<int64_t> _ticks = std::nullopt;
+};
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,214 @@
+#include <mlplc/periph/analog_group.hpp>
+#include "dtb.hpp"
+#include "macro.hpp"
+
+#if defined(CONFIG_ADC)
+
+#include <zephyr/drivers/adc.h>
+
+#include <bit>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mlplc {
+namespace periph {
+
+AnalogBlock::AnalogBlock(AnalogGroup* group, uint8_t idx) :
+    _group(group),
+    _idx(idx),
+    _samples(group->_block(idx), group->_block_samplings * group->_size),
+    _channels(group->_size),
+    _sequence(group->_block_info[idx].sequence),
+    _time(group->_block_info[idx].time)
+{}
+
+AnalogBlock::AnalogBlock(AnalogBlock&& other) noexcept :
+    _group(std::exchange(other._group, nullptr)),
+    _idx(other._idx),
+    _samples(other._samples),
+    _channels(other._channels),
+    _sequence(other._sequence),
+    _time(other._time)
+{}
+
+AnalogBlock& AnalogBlock::operator= (AnalogBlock&& other) noexcept {
+    if (this != &other) {
+        if (this->_group) {
+            this->_group->_release(this->_idx);
+        }
+        this->_group = std::exchange(other._group, nullptr);
+        this->_idx = other._idx;
+        this->_samples = other._samples;
+        this->_channels = other._channels;
+        this->_sequence = other._sequence;
+        this->_time = other._time;
+    }
+    return *this;
+}
+
+AnalogBlock::~AnalogBlock() {
+    if (this->_group) {
+        this->_group->_release(this->_idx);
+    }
+}
+
+int16_t AnalogBlock::at(std::size_t sampling, std::size_t channel) const {
+    return this->_samples[sampling * this->_channels + this->_group->position(channel)];
+}
+
+AnalogGroup::AnalogGroup(std::span<uint8_t const> channels, std::chrono::microseconds interval,
+    std::size_t block_samplings, std::size_t blocks) :
+    _interval(interval),
+    _block_samplings(block_samplings)
+{
+    ASSERT(!channels.empty() && channels.size() <= ANALOG_GROUP_MAX_SIZE, ExceptionType::InvalidArgument,
+        "Wrong count of channels in group: ", channels.size());
+    ASSERT(blocks >= 2 && blocks <= ANALOG_GROUP_MAX_BLOCKS, ExceptionType::InvalidArgument,
+        "Wrong count of blocks: ", blocks);
+    // One block is one ADC sequence, its sampling count is limited by extra_samplings.
+    ASSERT(block_samplings > 0 && block_samplings <= std::numeric_limits<uint16_t>::max() + 1u,
+        ExceptionType::InvalidArgument, "Wrong count of block samplings: ", block_samplings);
+
+    for (std::size_t i = 0; i < channels.size(); i++) {
+        this->_specs[i] = dtb::borrow_adc(channels[i]);
+        this->_size = i + 1;
+        auto const& spec = this->_specs[i];
+        ASSERT(adc_is_ready_dt(spec.get()), ExceptionType::NoDev, "ADC is not ready");
+        if (!this->_dev) {
+            this->_dev = spec->dev;
+            this->_resolution = spec->resolution;
+            this->_oversampling = spec->oversampling;
+        }
+        ASSERT(this->_dev == spec->dev, ExceptionType::NoDev, "Group channels must belong to one ADC");
+        ASSERT(!(this->_channel_mask & BIT(spec->channel_id)), ExceptionType::DeviceAlreadyInUse,
+            "ADC channel is used twice: ", static_cast<int>(spec->channel_id));
+        CCALL(adc_channel_setup_dt(spec.get()));
+        this->_channel_mask |= BIT(spec->channel_id);
+    }
+    for (std::size_t i = 0; i < this->_size; i++) {
+        this->_position[i] = std::popcount(this->_channel_mask & (BIT(this->_specs[i]->channel_id) - 1));
+    }
+
+    this->_buffer.reset(new (std::nothrow) int16_t[blocks * block_samplings * this->_size]);
+    ASSERT(this->_buffer, ExceptionType::NoMemory, "Analog group buffer");
+
+    k_msgq_init(&this->_free, reinterpret_cast<char*>(this->_free_buf.data()), sizeof(uint8_t), blocks);
+    k_msgq_init(&this->_filled, reinterpret_cast<char*>(this->_filled_buf.data()), sizeof(uint8_t), blocks);
+    for (std::size_t i = 0; i < blocks; i++) {
+        uint8_t const idx = i;
+        CCALL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+    }
+}
+
+AnalogGroup::AnalogGroup(std::initializer_list<uint8_t> channels, std::chrono::microseconds interval,
+    std::size_t block_samplings, std::size_t blocks) :
+    AnalogGroup(std::span<uint8_t const>(channels.begin(), channels.size()), interval, block_samplings, blocks) {}
+
+AnalogGroup::~AnalogGroup() {
+    this->stop();
+}
+
+void AnalogGroup::read(std::span<int16_t> samples) {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    ASSERT(!this->_thread, ExceptionType::DeviceAlreadyInUse, "Continuous sampling is running");
+    ASSERT(!samples.empty() && 0 == samples.size() % this->_size, ExceptionType::InvalidArgument,
+        "Buffer size must be multiple of channel count: ", samples.size());
+    CCALL(this->_read(samples.data(), samples.size() / this->_size));
+}
+
+void AnalogGroup::start(uint8_t priority) {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    if (this->_thread) {
+        return;
+    }
+    // Blocks not taken during previous run are stale.
+    uint8_t idx = 0;
+    while (0 == k_msgq_get(&this->_filled, &idx, K_NO_WAIT)) {
+        CCALL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+    }
+    this->_is_running.store(true, std::memory_order_release);
+    this->_thread = std::make_unique<sys::Thread<>>("analog_group", [this]() { this->_run(); },
+        THREAD_STACK_SIZE, priority);
+    this->_thread->start();
+}
+
+void AnalogGroup::stop() {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    if (!this->_thread) {
+        return;
+    }
+    this->_is_running.store(false, std::memory_order_release);
+    this->_thread->join();
+    this->_thread = nullptr;
+}
+
+std::optional<AnalogBlock> AnalogGroup::wait_block(sys::timeout_t timeout) {
+    uint8_t idx = 0;
+    if (0 != k_msgq_get(&this->_filled, &idx, sys::Deadline(timeout).k_timeout())) {
+        return std::nullopt;
+    }
+    return AnalogBlock(this, idx);
+}
+
+int32_t AnalogGroup::to_millivolts(std::size_t channel, int16_t raw) const {
+    int32_t value = raw;
+    CCALL(adc_raw_to_millivolts_dt(this->_specs[channel].get(), &value));
+    return value;
+}
+
+int AnalogGroup::_read(int16_t* buffer, std::size_t samplings) {
+    struct adc_sequence_options const options = {
+        .interval_us = static_cast<uint32_t>(this->_interval.count()),
+        .callback = nullptr,
+        .user_data = nullptr,
+        .extra_samplings = static_cast<uint16_t>(samplings - 1)};
+    struct adc_sequence const sequence = {
+        .options = &options,
+        .channels = this->_channel_mask,
+        .buffer = buffer,
+        .buffer_size = samplings * this->_size * sizeof(int16_t),
+        .resolution = this->_resolution,
+        .oversampling = this->_oversampling,
+        .calibrate = false};
+    return adc_read(this->_dev, &sequence);
+}
+
+void AnalogGroup::_run() {
+    auto const block_duration = this->_interval * this->_block_samplings;
+    uint32_t sequence = 0;
+    while (this->_is_running.load(std::memory_order_acquire)) {
+        uint8_t idx = 0;
+        if (0 != k_msgq_get(&this->_free, &idx, K_NO_WAIT)) {
+            if (0 == k_msgq_get(&this->_filled, &idx, K_NO_WAIT)) {
+                // Consumer is late, the oldest queued block is dropped and refilled.
+                this->_overruns.fetch_add(1, std::memory_order_relaxed);
+            } else if (0 != k_msgq_get(&this->_free, &idx, K_USEC(block_duration.count()))) {
+                // Every block is held by consumer, each block time without free block is one lost block.
+                this->_overruns.fetch_add(1, std::memory_order_relaxed);
+                sequence += 1;
+                continue;
+            }
+        }
+        this->_block_info[idx] = BlockInfo{.sequence = sequence, .time = sys::now()};
+        sequence += 1;
+        if (0 != this->_read(this->_block(idx), this->_block_samplings)) {
+            this->_errors.fetch_add(1, std::memory_order_relaxed);
+            CCALL_UNTIL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+            continue;
+        }
+        this->_blocks_filled.fetch_add(1, std::memory_order_relaxed);
+        // Never blocks, filled queue has place for every block.
+        CCALL_UNTIL(k_msgq_put(&this->_filled, &idx, K_NO_WAIT));
+    }
+}
+
+void AnalogGroup::_release(uint8_t idx) {
+    CCALL_UNTIL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+}
+
+} // namespace periph
+} // namespace mlplc
+
+#endif // CONFIG_ADC
@@ -0,0 +1,55 @@
+#include <mlplc/sys/clock.hpp>
+#include <mlplc/sys/spinlock.hpp>
+
+#include <zephyr/init.h>
+
+#include <mutex>
+
+namespace mlplc {
+namespace sys {
+
+#if defined(CONFIG_TIMER_HAS_64BIT_CYCLE_COUNTER)
+
+uint64_t cycles() {
+    return k_cycle_get_64();
+}
+
+#else
+
+namespace {
+
+SpinLock cycles_lock;
+uint32_t cycles_last = 0;
+uint32_t cycles_high = 0;
+
+void cycles_keeper_handler([[maybe_unused]] struct k_timer* timer) {
+    cycles();
+}
+
+K_TIMER_DEFINE(cycles_keeper, cycles_keeper_handler, NULL);
+
+int cycles_keeper_init() {
+    // Counter is read at least 4 times per wrap.
+    uint64_t const wrap_ms = (uint64_t(1) << 32) * 1000 / sys_clock_hw_cycles_per_sec();
+    k_timer_start(&cycles_keeper, K_MSEC(wrap_ms / 4), K_MSEC(wrap_ms / 4));
+    return 0;
+}
+
+SYS_INIT(cycles_keeper_init, APPLICATION, 0);
+
+} // namespace
+
+uint64_t cycles() {
+    std::lock_guard<SpinLock> lock(cycles_lock);
+    uint32_t const low = k_cycle_get_32();
+    if (low < cycles_last) {
+        cycles_high += 1;
+    }
+    cycles_last = low;
+    return (uint64_t(cycles_high) << 32) | low;
+}
+
+#endif
+
+} // namespace sys
+} // namespace mlplc
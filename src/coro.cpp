@@ -0,0 +1,183 @@
+#include <mlplc/sys/coro.hpp>
+#include <mlplc/sys/timeout.hpp>
+
+#include <mutex>
+
+namespace mlplc {
+namespace sys {
+
+std::coroutine_handle<> Task::FinalAwaiter::await_suspend(handle_t handle) noexcept {
+    auto& promise = handle.promise();
+    if (promise.continuation) {
+        return promise.continuation;
+    }
+    if (promise.is_detached) {
+        // Spawned task frame is not owned by any Task object, so scheduler destroys it.
+        promise.scheduler->_on_task_done(handle);
+    }
+    return std::noop_coroutine();
+}
+
+Scheduler::Scheduler() {
+    k_timer_init(&this->_timer, Scheduler::_on_timer, NULL);
+    k_timer_user_data_set(&this->_timer, this);
+}
+
+Scheduler::~Scheduler() {
+    k_timer_stop(&this->_timer);
+    {
+        std::lock_guard<SpinLock> lock(this->_lock);
+        this->_ready_head = nullptr;
+        this->_ready_tail = nullptr;
+    }
+    this->_timers = nullptr;
+    // Destroying frames destroys their awaiters, which unsubscribe from event sources.
+    while (this->_tasks) {
+        Task::promise_type* const promise = this->_tasks;
+        this->_tasks = promise->next;
+        Task::handle_t::from_promise(*promise).destroy();
+    }
+}
+
+void Scheduler::spawn(Task task) {
+    Task::handle_t const handle = std::exchange(task._handle, nullptr);
+    auto& promise = handle.promise();
+    promise.scheduler = this;
+    promise.is_detached = true;
+    promise.prev = nullptr;
+    promise.next = this->_tasks;
+    if (this->_tasks) {
+        this->_tasks->prev = &promise;
+    }
+    this->_tasks = &promise;
+    this->_task_count += 1;
+
+    promise.waiter.handle = handle;
+    this->wake(&promise.waiter);
+}
+
+void Scheduler::run() {
+    this->_events.clear(EVENT_STOP);
+    while (this->_task_count > 0) {
+        uint32_t const events = this->_events.wait(EVENT_READY | EVENT_TIMER | EVENT_STOP, Deadline(FOREVER));
+        // Clear before handling, so event posted meanwhile is not lost.
+        this->_events.clear(events & (EVENT_READY | EVENT_TIMER));
+        if (events & EVENT_STOP) {
+            return;
+        }
+        if (events & EVENT_TIMER) {
+            this->_expire_timers();
+        }
+        while (Waiter* const waiter = this->_pop_ready()) {
+            waiter->handle.resume();
+        }
+    }
+}
+
+void Scheduler::stop() {
+    this->_events.post(EVENT_STOP);
+}
+
+void Scheduler::wake(Waiter* waiter) {
+    {
+        std::lock_guard<SpinLock> lock(this->_lock);
+        waiter->ready_next = nullptr;
+        if (this->_ready_tail) {
+            this->_ready_tail->ready_next = waiter;
+        } else {
+            this->_ready_head = waiter;
+        }
+        this->_ready_tail = waiter;
+    }
+    this->_events.post(EVENT_READY);
+}
+
+void Scheduler::sleep_until(Waiter* waiter, int64_t deadline) {
+    this->cancel_sleep(waiter);
+    waiter->deadline = deadline;
+    waiter->is_sleeping = true;
+    Waiter** p = &this->_timers;
+    while (*p && (*p)->deadline <= deadline) {
+        p = &(*p)->timer_next;
+    }
+    waiter->timer_next = *p;
+    *p = waiter;
+    if (this->_timers == waiter) {
+        this->_rearm_timer();
+    }
+}
+
+void Scheduler::cancel_sleep(Waiter* waiter) {
+    if (!waiter->is_sleeping) {
+        return;
+    }
+    waiter->is_sleeping = false;
+    for (Waiter** p = &this->_timers; *p; p = &(*p)->timer_next) {
+        if (*p == waiter) {
+            *p = waiter->timer_next;
+            break;
+        }
+    }
+}
+
+Waiter* Scheduler::_pop_ready() {
+    std::lock_guard<SpinLock> lock(this->_lock);
+    Waiter* const waiter = this->_ready_head;
+    if (waiter) {
+        this->_ready_head = waiter->ready_next;
+        if (!this->_ready_head) {
+            this->_ready_tail = nullptr;
+        }
+    }
+    return waiter;
+}
+
+void Scheduler::_expire_timers() {
+    int64_t const now = k_uptime_ticks();
+    while (this->_timers && this->_timers->deadline <= now) {
+        Waiter* const waiter = this->_timers;
+        this->_timers = waiter->timer_next;
+        waiter->is_sleeping = false;
+        if (waiter->on_deadline) {
+            waiter->on_deadline(waiter);
+        } else {
+            this->wake(waiter);
+        }
+    }
+    this->_rearm_timer();
+}
+
+void Scheduler::_rearm_timer() {
+    if (this->_timers) {
+        k_timer_start(&this->_timer, K_TIMEOUT_ABS_TICKS(this->_timers->deadline), K_NO_WAIT);
+    } else {
+        k_timer_stop(&this->_timer);
+    }
+}
+
+void Scheduler::_on_task_done(Task::handle_t handle) {
+    auto& promise = handle.promise();
+    if (promise.prev) {
+        promise.prev->next = promise.next;
+    } else {
+        this->_tasks = promise.next;
+    }
+    if (promise.next) {
+        promise.next->prev = promise.prev;
+    }
+    this->_task_count -= 1;
+#if defined(CONFIG_CPP_EXCEPTIONS)
+    if (promise.error) {
+        this->_errors += 1;
+    }
+#endif
+    handle.destroy();
+}
+
+void Scheduler::_on_timer(struct k_timer* timer) {
+    auto* const self = static_cast<Scheduler*>(k_timer_user_data_get(timer));
+    self->_events.post(EVENT_TIMER);
+}
+
+} // namespace sys
+} // namespace mlplc
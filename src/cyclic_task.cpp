@@ -0,0 +1,139 @@
+#include <mlplc/sys/cyclic_task.hpp>
+#include "macro.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+namespace mlplc {
+namespace sys {
+
+namespace {
+
+/// Checked before thread member is created - destroying created and never started thread is fatal.
+std::chrono::microseconds checked_period(std::chrono::microseconds period) {
+    ASSERT(period.count() > 0, ExceptionType::InvalidArgument, "Cycle period must be positive: ", period.count());
+    return period;
+}
+
+} // namespace
+
+std::chrono::microseconds CycleStats::jitter_percentile(float percentile) const {
+    uint32_t total = 0;
+    for (auto const n : this->jitter_histogram) {
+        total += n;
+    }
+    uint32_t const target = static_cast<uint32_t>(static_cast<float>(total) * percentile / 100.0f);
+    uint32_t count = 0;
+    for (std::size_t bin = 0; bin < JITTER_BINS; bin++) {
+        count += this->jitter_histogram[bin];
+        if (count >= target) {
+            return std::min<std::chrono::microseconds>(JITTER_BIN_WIDTH * (bin + 1), this->jitter_max);
+        }
+    }
+    return this->jitter_max;
+}
+
+CyclicTask::CyclicTask(
+    std::string_view name,
+    std::chrono::microseconds period,
+    std::function<void()> logic,
+    std::size_t stack_size,
+    uint8_t priority,
+    std::function<void()> read_inputs,
+    std::function<void()> write_outputs) :
+    _period(checked_period(period)),
+    _logic(logic),
+    _read_inputs(read_inputs),
+    _write_outputs(write_outputs),
+    _thread(name, [this]() { this->_run(); }, stack_size, priority)
+{}
+
+CyclicTask::~CyclicTask() {
+    this->stop();
+}
+
+void CyclicTask::start() {
+    std::lock_guard<Mutex> lock(this->_mutex);
+    if (!this->_is_started) {
+        this->_is_started = true;
+        this->_is_running = true;
+        this->_thread.start();
+    }
+}
+
+void CyclicTask::stop() {
+    bool const is_task_thread = k_current_get() == this->_tid.load(std::memory_order_acquire);
+    {
+        std::lock_guard<Mutex> lock(this->_mutex);
+        this->_is_running = false;
+        if (!this->_is_started) {
+            // Never started thread can't be destroyed, so let it finish without cycles.
+            this->_is_started = true;
+            this->_thread.start();
+        }
+    }
+    // Task thread can't join itself.
+    if (!is_task_thread) {
+        this->_thread.join();
+    }
+}
+
+void CyclicTask::set_on_overrun(std::function<void(CycleStats const&)> on_overrun) {
+    std::lock_guard<Mutex> lock(this->_mutex);
+    this->_on_overrun = on_overrun;
+}
+
+void CyclicTask::_run() {
+    this->_tid.store(k_current_get(), std::memory_order_release);
+    int64_t const period_ticks = k_us_to_ticks_ceil64(this->_period.count());
+    CycleStats stats{};
+    int64_t deadline = k_uptime_ticks();
+
+    while (this->_is_running) {
+        k_sleep(K_TIMEOUT_ABS_TICKS(deadline));
+
+        int64_t const t_start = k_uptime_ticks();
+        uint32_t const cyc_start = k_cycle_get_32();
+
+        if (this->_read_inputs) {
+            this->_read_inputs();
+        }
+        if (this->_logic) {
+            this->_logic();
+        }
+        if (this->_write_outputs) {
+            this->_write_outputs();
+        }
+
+        auto const exec = std::chrono::microseconds(k_cyc_to_us_floor32(k_cycle_get_32() - cyc_start));
+        auto const jitter = std::chrono::microseconds(k_ticks_to_us_floor64(t_start - deadline));
+        stats.cycles += 1;
+        stats.exec_last = exec;
+        stats.exec_min = std::min(stats.exec_min, exec);
+        stats.exec_max = std::max(stats.exec_max, exec);
+        stats.jitter_min = std::min(stats.jitter_min, jitter);
+        stats.jitter_max = std::max(stats.jitter_max, jitter);
+        std::size_t const bin = std::min<std::size_t>(jitter / CycleStats::JITTER_BIN_WIDTH, CycleStats::JITTER_BINS - 1);
+        stats.jitter_histogram[bin] += 1;
+
+        deadline += period_ticks;
+        int64_t const now = k_uptime_ticks();
+        bool const is_overrun = now > deadline;
+        if (is_overrun) {
+            stats.overruns += 1;
+            // Skip missed deadlines instead of bursting to catch up.
+            deadline += ((now - deadline) / period_ticks + 1) * period_ticks;
+        }
+        this->_stats.write(stats);
+
+        if (is_overrun) {
+            std::lock_guard<Mutex> lock(this->_mutex);
+            if (this->_on_overrun) {
+                this->_on_overrun(stats);
+            }
+        }
+    }
+}
+
+} // namespace sys
+} // namespace mlplc
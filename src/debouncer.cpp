@@ -0,0 +1,186 @@
+#include "debouncer.hpp"
+#include "macro.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <utility>
+
+namespace mlplc {
+namespace periph {
+namespace _private {
+
+namespace {
+
+void debounce_timer_handler([[maybe_unused]] struct k_timer* timer) {
+    g_debouncer.on_tick();
+}
+
+K_TIMER_DEFINE(debounce_timer, debounce_timer_handler, NULL);
+
+} // namespace
+
+Debouncer g_debouncer;
+
+expected<void> Debouncer::add(uint8_t gpio_idx, struct gpio_dt_spec const& spec, std::chrono::microseconds duration,
+    sys::Event* event, uint32_t event_bit, sys::Listener* listener)
+{
+    Slot* const slot = this->_slot(gpio_idx);
+    TRY_ASSERT(slot, ExceptionType::NoDev);
+    gpio_port_value_t value = 0;
+    TRY_CCALL(gpio_port_get(spec.port, &value));
+
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    std::size_t p = 0;
+    while (p < this->_port_count && this->_ports[p].dev != spec.port) {
+        p++;
+    }
+    if (p == this->_port_count) {
+        this->_ports[p].dev = spec.port;
+        this->_port_count += 1;
+    }
+
+    Port& port = this->_ports[p];
+    uint32_t const bit = BIT(spec.pin);
+    for (auto& plane : port.counter) {
+        plane &= ~bit;
+    }
+    port.state = (port.state & ~bit) | (value & bit);
+    port.levels = port.state;
+    port.pending &= ~bit;
+    port.edges &= ~bit;
+    this->_set_threshold(port, bit, duration);
+    port.pins |= bit;
+
+    *slot = Slot{.is_used = true, .port = static_cast<uint8_t>(p), .bit = bit, .event = event,
+        .event_bit = event_bit, .listener = listener};
+    this->_pin_count += 1;
+    if (1 == this->_pin_count) {
+        k_timer_start(&debounce_timer, K_USEC(DEBOUNCE_TICK.count()), K_USEC(DEBOUNCE_TICK.count()));
+    }
+    return {};
+}
+
+void Debouncer::remove(uint8_t gpio_idx) {
+    Slot* const slot = this->_slot(gpio_idx);
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    if (!slot || !slot->is_used) {
+        return;
+    }
+    this->_ports[slot->port].pins &= ~slot->bit;
+    *slot = Slot{};
+    this->_pin_count -= 1;
+    if (0 == this->_pin_count) {
+        k_timer_stop(&debounce_timer);
+    }
+}
+
+void Debouncer::set_duration(uint8_t gpio_idx, std::chrono::microseconds duration) {
+    Slot const* const slot = this->_slot(gpio_idx);
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    if (slot && slot->is_used) {
+        this->_set_threshold(this->_ports[slot->port], slot->bit, duration);
+    }
+}
+
+std::optional<Level> Debouncer::level(uint8_t gpio_idx) const {
+    Slot const* const slot = this->_slot(gpio_idx);
+    if (!slot || !slot->is_used) {
+        return std::nullopt;
+    }
+    Port const& port = this->_ports[slot->port];
+    if (port.pending.load(std::memory_order_acquire) & slot->bit) {
+        return std::nullopt;
+    }
+    return level_from_num(port.levels.load(std::memory_order_acquire) & slot->bit);
+}
+
+bool Debouncer::take_edge(uint8_t gpio_idx) {
+    Slot const* const slot = this->_slot(gpio_idx);
+    if (!slot || !slot->is_used) {
+        return false;
+    }
+    return this->_ports[slot->port].edges.fetch_and(~slot->bit, std::memory_order_acq_rel) & slot->bit;
+}
+
+Debouncer::Slot* Debouncer::_slot(uint8_t gpio_idx) {
+    return const_cast<Slot*>(std::as_const(*this)._slot(gpio_idx));
+}
+
+Debouncer::Slot const* Debouncer::_slot(uint8_t gpio_idx) const {
+    auto const pos = dtb::_private::device_pos(dtb::DeviceId{dtb::DeviceType::Gpio, gpio_idx});
+    if (!pos || *pos >= dtb::GPIO_COUNT) {
+        return nullptr;
+    }
+    return &this->_slots[*pos];
+}
+
+void Debouncer::on_tick() {
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    for (std::size_t p = 0; p < this->_port_count; p++) {
+        Port& port = this->_ports[p];
+        if (0 == port.pins) {
+            continue;
+        }
+        gpio_port_value_t raw = 0;
+        if (0 != gpio_port_get(port.dev, &raw)) {
+            continue;
+        }
+
+        // Pins which differ from debounced level count up, others restart from zero.
+        uint32_t const diff = (raw ^ port.state) & port.pins;
+        uint32_t carry = diff;
+        for (auto& plane : port.counter) {
+            plane &= diff;
+            uint32_t const next_carry = plane & carry;
+            plane ^= carry;
+            carry = next_carry;
+        }
+
+        uint32_t reached = diff;
+        uint32_t pending = 0;
+        for (std::size_t k = 0; k < DEBOUNCE_PLANES; k++) {
+            reached &= ~(port.counter[k] ^ port.threshold[k]);
+        }
+        for (auto& plane : port.counter) {
+            plane &= ~reached;
+            pending |= plane;
+        }
+
+        port.state ^= reached;
+        port.levels.store(port.state, std::memory_order_release);
+        port.pending.store(pending, std::memory_order_release);
+        if (reached) {
+            port.edges.fetch_or(reached, std::memory_order_acq_rel);
+            this->_notify(p, reached);
+        }
+    }
+}
+
+void Debouncer::_set_threshold(Port& port, uint32_t bit, std::chrono::microseconds duration) {
+    // At least one tick, counter never equals zero threshold. One tick takes the first differing sample,
+    // i.e. level follows pin with one sample delay.
+    auto const clamped = std::clamp(duration, DEBOUNCE_TICK, DEBOUNCE_MAX);
+    uint32_t const ticks = (clamped.count() + DEBOUNCE_TICK.count() - 1) / DEBOUNCE_TICK.count();
+    for (std::size_t k = 0; k < DEBOUNCE_PLANES; k++) {
+        port.threshold[k] = (ticks & BIT(k)) ? (port.threshold[k] | bit) : (port.threshold[k] & ~bit);
+    }
+}
+
+void Debouncer::_notify(std::size_t port_idx, uint32_t edges) {
+    uint32_t const levels = this->_ports[port_idx].state;
+    for (auto const& slot : this->_slots) {
+        if (!slot.is_used || slot.port != port_idx || !(slot.bit & edges)) {
+            continue;
+        }
+        if (slot.event) {
+            slot.event->post(slot.event_bit);
+        }
+        if (slot.listener) {
+            slot.listener->on_event(slot.listener, level_to_int(level_from_num(levels & slot.bit)));
+        }
+    }
+}
+
+} // namespace _private
+} // namespace periph
+} // namespace mlplc
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <mlplc/error.hpp>
+#include <mlplc/sys/event.hpp>
+#include <mlplc/sys/listener.hpp>
+#include <mlplc/sys/spinlock.hpp>
+#include <mlplc/periph/digital_common.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <optional>
+#include <cstdint>
+
+namespace mlplc {
+namespace periph {
+namespace _private {
+
+/// Sampling period of debounce engine.
+constexpr std::chrono::microseconds DEBOUNCE_TICK = 1000us;
+/// Bit-planes of vertical counters, i.e. counter width.
+constexpr std::size_t DEBOUNCE_PLANES = 8;
+/// Longest debounce time, longer one is clamped.
+constexpr std::chrono::microseconds DEBOUNCE_MAX = DEBOUNCE_TICK * ((1 << DEBOUNCE_PLANES) - 1);
+
+/** Background debounce of all registered inputs.
+ * Each DEBOUNCE_TICK pins are sampled port-wide from k_timer ISR, one driver call per gpio controller.
+ * Every pin of port has vertical counter - bit K of its count is bit of pin in plane K, so counters of
+ * all 32 pins of port are incremented, reset and compared with per-pin thresholds by few word operations.
+ * Pin which differs from its debounced level for threshold ticks in a row takes the new level.
+ * Debounced levels and edge flags are published in atomic words and are read without locks.
+ * Sampling from ISR requires gpio controllers with non-blocking port read, e.g. MCU gpio.
+ */
+class Debouncer {
+public:
+    /** Start debounce of gpio. Event bit is posted on each debounced edge.
+     * Listener, if set, is called from timer ISR with new debounced level as value, its result is ignored.
+     * Initial debounced level is current level.
+     */
+    expected<void> add(uint8_t gpio_idx, struct gpio_dt_spec const& spec, std::chrono::microseconds duration,
+        sys::Event* event, uint32_t event_bit, sys::Listener* listener = nullptr);
+
+    void remove(uint8_t gpio_idx);
+
+    void set_duration(uint8_t gpio_idx, std::chrono::microseconds duration);
+
+    /// Debounced level, std::nullopt while pin differs from it and debounce is in progress. Lock-free.
+    std::optional<Level> level(uint8_t gpio_idx) const;
+
+    /// Return and clear edge flag of pin. Lock-free.
+    bool take_edge(uint8_t gpio_idx);
+
+    void on_tick();
+
+private:
+    struct Port {
+        struct device const* dev = nullptr;
+        gpio_port_pins_t pins = 0;
+        std::array<uint32_t, DEBOUNCE_PLANES> counter{};
+        std::array<uint32_t, DEBOUNCE_PLANES> threshold{};
+        uint32_t state = 0;
+        std::atomic<uint32_t> levels = 0;
+        std::atomic<uint32_t> pending = 0;
+        std::atomic<uint32_t> edges = 0;
+    };
+
+    struct Slot {
+        bool is_used = false;
+        uint8_t port = 0;
+        uint32_t bit = 0;
+        sys::Event* event = nullptr;
+        uint32_t event_bit = 0;
+        sys::Listener* listener = nullptr;
+    };
+
+    sys::SpinLock _lock;
+    std::array<Port, dtb::GPIO_COUNT> _ports{};
+    std::size_t _port_count = 0;
+    /// Indexed by gpio device position, devicetree gpio indices may have gaps.
+    std::array<Slot, dtb::GPIO_COUNT> _slots{};
+    std::size_t _pin_count = 0;
+
+    /// Slot of gpio, nullptr for unknown gpio.
+    Slot* _slot(uint8_t gpio_idx);
+    Slot const* _slot(uint8_t gpio_idx) const;
+
+    void _set_threshold(Port& port, uint32_t bit, std::chrono::microseconds duration);
+    void _notify(std::size_t port_idx, uint32_t edges);
+};
+
+extern Debouncer g_debouncer;
+
+} // namespace _private
+} // namespace periph
+} // namespace mlplc
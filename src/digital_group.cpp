@@ -0,0 +1,128 @@
+#include <mlplc/periph/digital_group.hpp>
+#include "dtb.hpp"
+
+#include <zephyr/drivers/gpio.h>
+
+#include <mutex>
+
+namespace mlplc {
+namespace periph {
+
+namespace {
+
+gpio_flags_t input_flags(InputPull pull) {
+    if (InputPull::Down == pull) {
+        return GPIO_INPUT | GPIO_PULL_DOWN;
+    } else if (InputPull::Up == pull) {
+        return GPIO_INPUT | GPIO_PULL_UP;
+    }
+    return GPIO_INPUT;
+}
+
+gpio_flags_t output_flags(OutputType type) {
+    if (OutputType::OpenDrain == type) {
+        return GPIO_OUTPUT | GPIO_OPEN_DRAIN;
+    }
+    return GPIO_OUTPUT | GPIO_PUSH_PULL;
+}
+
+} // namespace
+
+namespace _private {
+
+DigitalGroup::DigitalGroup(std::span<uint8_t const> ports, gpio_flags_t flags) {
+    ASSERT(ports.size() <= GROUP_MAX_SIZE, ExceptionType::NoMemory, "Too many pins in group: ", ports.size());
+
+    for (std::size_t i = 0; i < ports.size(); i++) {
+        this->_specs[i] = dtb::borrow_gpio(ports[i]);
+        this->_size = i + 1;
+        auto const& spec = this->_specs[i];
+
+        std::size_t p = 0;
+        while (p < this->_port_count && this->_ports[p].dev != spec->port) {
+            p++;
+        }
+        if (p == this->_port_count) {
+            this->_ports[p].dev = spec->port;
+            this->_port_count += 1;
+        }
+        this->_ports[p].pins |= BIT(spec->pin);
+        if (spec->dt_flags & GPIO_ACTIVE_LOW) {
+            this->_ports[p].active_low |= BIT(spec->pin);
+        }
+        this->_pin_port[i] = p;
+
+        CCALL(gpio_pin_configure(spec->port, spec->pin, flags));
+    }
+}
+
+DigitalGroup::~DigitalGroup() {
+    for (std::size_t i = 0; i < this->_size; i++) {
+        gpio_pin_configure(this->_specs[i]->port, this->_specs[i]->pin, DEINIT_GPIO_MODE);
+    }
+}
+
+group_mask_t DigitalGroup::_from_raw(std::array<gpio_port_value_t, GROUP_MAX_SIZE> const& raw) const {
+    group_mask_t levels = 0;
+    for (std::size_t i = 0; i < this->_size; i++) {
+        uint8_t const p = this->_pin_port[i];
+        gpio_port_value_t const value = raw[p] ^ this->_ports[p].active_low;
+        levels |= ((value >> this->_specs[i]->pin) & 1) << i;
+    }
+    return levels;
+}
+
+} // namespace _private
+
+DigitalInputGroup::DigitalInputGroup(std::span<uint8_t const> ports, InputPull pull) :
+    DigitalGroup(ports, input_flags(pull)) {}
+
+DigitalInputGroup::DigitalInputGroup(std::initializer_list<uint8_t> ports, InputPull pull) :
+    DigitalInputGroup(std::span<uint8_t const>(ports.begin(), ports.size()), pull) {}
+
+group_mask_t DigitalInputGroup::levels() const {
+    std::array<gpio_port_value_t, GROUP_MAX_SIZE> raw{};
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    for (std::size_t p = 0; p < this->_port_count; p++) {
+        CCALL(gpio_port_get_raw(this->_ports[p].dev, &raw[p]));
+    }
+    return this->_from_raw(raw);
+}
+
+DigitalOutputGroup::DigitalOutputGroup(std::span<uint8_t const> ports, OutputType type, group_mask_t levels) :
+    DigitalGroup(ports, output_flags(type))
+{
+    this->set_levels(levels);
+}
+
+DigitalOutputGroup::DigitalOutputGroup(std::initializer_list<uint8_t> ports, OutputType type, group_mask_t levels) :
+    DigitalOutputGroup(std::span<uint8_t const>(ports.begin(), ports.size()), type, levels) {}
+
+void DigitalOutputGroup::set_levels(group_mask_t mask, group_mask_t levels) {
+    std::array<gpio_port_pins_t, GROUP_MAX_SIZE> port_mask{};
+    std::array<gpio_port_value_t, GROUP_MAX_SIZE> port_value{};
+    for (std::size_t i = 0; i < this->_size; i++) {
+        if (mask & BIT(i)) {
+            uint8_t const p = this->_pin_port[i];
+            port_mask[p] |= BIT(this->_specs[i]->pin);
+            port_value[p] |= ((levels >> i) & 1) << this->_specs[i]->pin;
+        }
+    }
+
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    for (std::size_t p = 0; p < this->_port_count; p++) {
+        if (port_mask[p]) {
+            gpio_port_value_t const raw = port_value[p] ^ this->_ports[p].active_low;
+            CCALL(gpio_port_set_masked_raw(this->_ports[p].dev, port_mask[p], raw));
+        }
+    }
+    this->_levels = (this->_levels & ~mask) | (levels & mask);
+}
+
+group_mask_t DigitalOutputGroup::levels() const {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    return this->_levels;
+}
+
+} // namespace periph
+} // namespace mlplc
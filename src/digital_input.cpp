@@ -1,11 +1,15 @@
 #include <mlplc/periph/digital_input.hpp>
 #include "dtb.hpp"
+#include "debouncer.hpp"
 
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/devicetree/gpio.h>
 #include <zephyr/sys/printk.h>
 
+#include <algorithm>
 #include <mutex>
+#include <new>
+#include <utility>
 
 namespace mlplc {
 namespace periph {
@@ -14,20 +18,74 @@ using namespace std::chrono_literals;
 
 
 DigitalInput::DigitalInput(uint8_t port, InputPull pull, std::chrono::milliseconds debounce_duration) :
+    DigitalInput(dtb::borrow_gpio(port), port, pull, debounce_duration)
+{
+    unwrap(this->_init());
+}
+
+DigitalInput::DigitalInput(
+    dtb::gpio_spec_t spec,
+    uint8_t port,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration) :
     _port(port),
     _pull(pull),
     _debounce_duration(debounce_duration),
-    _spec(dtb::borrow_gpio(port))
+    _spec(std::move(spec))
+{}
+
+expected<std::unique_ptr<DigitalInput>> DigitalInput::new_unique(
+    uint8_t port,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration)
 {
+    auto spec = dtb::try_borrow_gpio(port);
+    if (!spec) {
+        return std::unexpected(spec.error());
+    }
+    std::unique_ptr<DigitalInput> input(new (std::nothrow) DigitalInput(std::move(*spec), port, pull, debounce_duration));
+    TRY_ASSERT(input, ExceptionType::NoMemory);
+    TRY(input->_init());
+    return input;
+}
+
+expected<std::shared_ptr<DigitalInput>> DigitalInput::new_shared(
+    uint8_t port,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration)
+{
+    auto input = DigitalInput::new_unique(port, pull, debounce_duration);
+    if (!input) {
+        return std::unexpected(input.error());
+    }
+    return std::shared_ptr<DigitalInput>(std::move(*input));
+}
+
+expected<void> DigitalInput::_init() {
     gpio_flags_t flags = 0;
     if (InputPull::Down == this->_pull) {
         flags = GPIO_PULL_DOWN;
     } else if (InputPull::Up == this->_pull) {
         flags = GPIO_PULL_UP;
     }
-    CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_INPUT | flags));
-    this->_prev_level = this->level();
-    this->_prev_level_debounced = this->_prev_level;
+    TRY_CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_INPUT | flags));
+    this->_prev_level = level_from_num(gpio_pin_get_dt(this->_spec.get()));
+    this->_tl_level_change = sys::now();
+    TRY(_private::g_debouncer.add(this->_port, *this->_spec, this->_debounce_duration,
+        &this->_events, EVENT_EDGE_DEBOUNCED));
+
+    // Not every pin can have interrupt (e.g. STM32 EXTI line is shared between ports),
+    // in this case input falls back to polling.
+    this->_edge_callback.self = this;
+    gpio_init_callback(&this->_edge_callback.cb, DigitalInput::_on_edge, BIT(this->_spec->pin));
+    if (0 == gpio_add_callback(this->_spec->port, &this->_edge_callback.cb)) {
+        if (0 == gpio_pin_interrupt_configure_dt(this->_spec.get(), GPIO_INT_EDGE_BOTH)) {
+            this->_is_edge_irq = true;
+        } else {
+            gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+        }
+    }
+    return {};
 }
 
 DigitalInput::DigitalInput(
@@ -37,6 +95,11 @@ DigitalInput::DigitalInput(
     DigitalInput(dtb::find_gpio_idx_by_label(label), pull, debounce_duration) {}
 
 DigitalInput::~DigitalInput() {
+    _private::g_debouncer.remove(this->_port);
+    if (this->_is_edge_irq) {
+        gpio_pin_interrupt_configure_dt(this->_spec.get(), GPIO_INT_DISABLE);
+        gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+    }
     gpio_pin_configure(this->_spec->port, this->_spec->pin, DEINIT_GPIO_MODE);
 }
 
@@ -46,24 +109,94 @@ Level DigitalInput::level() const {
 }
 
 Level DigitalInput::_level() const {
+    auto const time = sys::now();
     Level const new_level = level_from_num(gpio_pin_get_dt(this->_spec.get()));
+    this->_update_level(new_level, time);
+    return new_level;
+}
+
+void DigitalInput::_update_level(Level new_level, std::chrono::nanoseconds time) const {
+    std::lock_guard<sys::SpinLock> lock(this->_state_lock);
     if (new_level != this->_prev_level) {
-        this->_tl_level_change = sys::uptime();
+        this->_tl_level_change = time;
+        this->_edges[this->_edge_count % EDGE_HISTORY_SIZE] = Edge{.time = time, .level = new_level};
+        this->_edge_count += 1;
         this->_prev_level = new_level;
         this->_is_level_changed = true;
+        this->_listeners.notify(level_to_int(new_level));
     }
-    return new_level;
 }
 
-void DigitalInput::wait_level(Level level) const {
-    while (this->level() != level) {
+void DigitalInput::add_listener(sys::Listener* listener) const {
+    std::lock_guard<sys::SpinLock> lock(this->_state_lock);
+    this->_listeners.add(listener);
+}
+
+void DigitalInput::remove_listener(sys::Listener* listener) const {
+    std::lock_guard<sys::SpinLock> lock(this->_state_lock);
+    this->_listeners.remove(listener);
+}
+
+void DigitalInput::_on_edge(
+    [[maybe_unused]] struct device const* port,
+    struct gpio_callback* cb,
+    [[maybe_unused]] gpio_port_pins_t pins)
+{
+    DigitalInput const* const self = CONTAINER_OF(cb, EdgeCallback, cb)->self;
+    // Timestamp first, before any other ISR work.
+    auto const time = sys::now();
+    self->_update_level(level_from_num(gpio_pin_get_dt(self->_spec.get())), time);
+    self->_events.post(EVENT_EDGE);
+}
+
+bool DigitalInput::_wait_edge_event(sys::Deadline const& deadline) const {
+    if (this->_is_edge_irq) {
+        return 0 != this->_events.wait(EVENT_EDGE, deadline);
+    }
+
+    auto const remain = deadline.remain();
+    if (remain && *remain < GPIO_WAIT) {
+        k_sleep(deadline.k_timeout());
+    } else {
         sys::sleep(GPIO_WAIT);
     }
+    return !deadline.is_expired();
+}
+
+bool DigitalInput::wait_level(Level level, sys::timeout_t timeout) const {
+    sys::Deadline const deadline(timeout);
+    while (1) {
+        // Clear before check, so edge between check and wait is not lost.
+        this->_events.clear(EVENT_EDGE);
+        if (this->level() == level) {
+            return true;
+        }
+        if (!this->_wait_edge_event(deadline)) {
+            return this->level() == level;
+        }
+    }
+}
+
+std::optional<Level> DigitalInput::wait_edge(sys::timeout_t timeout) const {
+    sys::Deadline const deadline(timeout);
+    this->_events.clear(EVENT_EDGE);
+    Level const start_level = this->level();
+    while (this->_wait_edge_event(deadline)) {
+        if (this->_is_edge_irq) {
+            return this->level();
+        }
+        Level const new_level = this->level();
+        if (new_level != start_level) {
+            return new_level;
+        }
+    }
+    return std::nullopt;
 }
 
 std::optional<Level> DigitalInput::is_level_changed() const {
     std::lock_guard<sys::Mutex> lock(this->_mutex);
     Level const new_level = this->_level();
+    std::lock_guard<sys::SpinLock> state_lock(this->_state_lock);
     if (this->_is_level_changed) {
         this->_is_level_changed = false;
         return new_level;
@@ -79,39 +212,46 @@ LevelDuration DigitalInput::level_duration() const {
 
 LevelDuration DigitalInput::_level_duration() const {
     Level const current_level = this->_level();
-    auto const now = sys::uptime();
-    return LevelDuration {.duration = now - this->_tl_level_change, .level = current_level};
+    auto const now = sys::now();
+    std::lock_guard<sys::SpinLock> lock(this->_state_lock);
+    return LevelDuration {
+        .duration = std::chrono::duration_cast<std::chrono::microseconds>(now - this->_tl_level_change),
+        .level = current_level};
 }
 
-std::optional<Level> DigitalInput::level_debounced() const {
-    std::lock_guard<sys::Mutex> lock(this->_mutex);
-    return this->_level_debounced();
+EdgeHistory DigitalInput::edge_history() const {
+    std::lock_guard<sys::SpinLock> lock(this->_state_lock);
+    EdgeHistory history{};
+    history.total = this->_edge_count;
+    history.size = std::min<std::size_t>(this->_edge_count, EDGE_HISTORY_SIZE);
+    uint32_t const first = this->_edge_count - history.size;
+    for (std::size_t i = 0; i < history.size; i++) {
+        history.edges[i] = this->_edges[(first + i) % EDGE_HISTORY_SIZE];
+    }
+    return history;
 }
 
-std::optional<Level> DigitalInput::_level_debounced() const {
-    auto const level_duration = this->_level_duration();
-    if (level_duration.duration >= this->_debounce_duration) {
-        if (this->_prev_level_debounced != level_duration.level) {
-            this->_prev_level_debounced = level_duration.level;
-            this->_is_level_debounced_changed = true;
-        }
-        return level_duration.level;
-    }
-    return std::nullopt;
+std::optional<Level> DigitalInput::level_debounced() const {
+    return _private::g_debouncer.level(this->_port);
 }
 
-void DigitalInput::wait_level_debounced(Level level) const {
-    while (this->level_debounced() != level) {
-        sys::sleep(GPIO_WAIT);
+bool DigitalInput::wait_level_debounced(Level level, sys::timeout_t timeout) const {
+    sys::Deadline const deadline(timeout);
+    while (1) {
+        // Clear before check, so debounced edge between check and wait is not lost.
+        this->_events.clear(EVENT_EDGE_DEBOUNCED);
+        if (this->level_debounced() == level) {
+            return true;
+        }
+        if (0 == this->_events.wait(EVENT_EDGE_DEBOUNCED, deadline)) {
+            return this->level_debounced() == level;
+        }
     }
 }
 
 std::optional<Level> DigitalInput::is_level_changed_debounced() const {
-    std::lock_guard<sys::Mutex> lock(this->_mutex);
-    auto new_level = this->_level_debounced();
-    if (new_level && this->_is_level_debounced_changed) {
-        this->_is_level_debounced_changed = false;
-        return new_level;
+    if (_private::g_debouncer.take_edge(this->_port)) {
+        return this->level_debounced();
     }
     return std::nullopt;
 }
@@ -119,6 +259,58 @@ std::optional<Level> DigitalInput::is_level_changed_debounced() const {
 void DigitalInput::set_debounce_duration(std::chrono::milliseconds debounce_duration) {
     std::lock_guard<sys::Mutex> lock(this->_mutex);
     this->_debounce_duration = debounce_duration;
+    _private::g_debouncer.set_duration(this->_port, debounce_duration);
+}
+
+EdgeAwaiter::EdgeAwaiter(DigitalInput const& input, std::optional<Level> level) :
+    _input(input),
+    _level_filter(level)
+{
+    this->on_event = EdgeAwaiter::_on_event;
+}
+
+EdgeAwaiter::~EdgeAwaiter() {
+    if (this->_scheduler) {
+        this->_input.remove_listener(this);
+        this->_scheduler->cancel_sleep(this);
+    }
+}
+
+void EdgeAwaiter::await_suspend(sys::Task::handle_t handle) {
+    this->handle = handle;
+    this->_scheduler = handle.promise().scheduler;
+    this->_input.add_listener(this);
+    if (!this->_input.is_edge_irq()) {
+        // Nobody reads polled input in background, so scheduler does it.
+        this->on_deadline = EdgeAwaiter::_on_poll;
+        this->_scheduler->sleep_until(this, k_uptime_ticks() + k_ms_to_ticks_ceil64(GPIO_WAIT.count()));
+    }
+}
+
+Level EdgeAwaiter::await_resume() {
+    this->_scheduler->cancel_sleep(this);
+    return this->_level;
+}
+
+bool EdgeAwaiter::_on_event(sys::Listener* listener, uint32_t value) {
+    auto* const self = static_cast<EdgeAwaiter*>(listener);
+    Level const level = level_from_num(value);
+    if (self->_level_filter && *self->_level_filter != level) {
+        return true;
+    }
+    self->_level = level;
+    self->_is_woken = true;
+    self->_scheduler->wake(self);
+    return false;
+}
+
+void EdgeAwaiter::_on_poll(sys::Waiter* waiter) {
+    auto* const self = static_cast<EdgeAwaiter*>(waiter);
+    // Level change is delivered to _on_event() by the read.
+    self->_input.level();
+    if (!self->_is_woken) {
+        self->_scheduler->sleep_until(self, k_uptime_ticks() + k_ms_to_ticks_ceil64(GPIO_WAIT.count()));
+    }
 }
 
 } // namespace periph
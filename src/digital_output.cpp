@@ -3,10 +3,15 @@
 
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/devicetree/gpio.h>
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/drivers/pinctrl.h>
+#endif
 
 #include <mutex>
-#include <unordered_map>
-#include <functional>
+#include <new>
+#include <array>
+#include <utility>
 #include <cstdint>
 
 namespace mlplc {
@@ -16,38 +21,175 @@ using namespace std::chrono_literals;
 
 namespace {
 
-constexpr std::size_t GPIO_HANDLER_STACK_SIZE = 2048;
-constexpr int8_t GPIO_HANDLER_PRIO = 1;
-constexpr uint32_t GPIO_HANDLER_OPTIONS = K_ESSENTIAL;
-constexpr std::chrono::microseconds GPIO_HANDLER_LOCK_TIMEOUT = 100us;
+void pulse_timer_handler(struct k_timer* timer);
 
-sys::Mutex g_gpio_handlers_mutex;
-std::unordered_map<uint8_t, std::function<void(std::chrono::milliseconds)>> g_gpio_handlers;
+K_TIMER_DEFINE(pulse_timer, pulse_timer_handler, NULL);
 
-void gpio_handler(void* arg1, void* arg2, void* arg3) {
-    while (1) {
-        {
-            std::lock_guard<sys::Mutex> lock(g_gpio_handlers_mutex);
-            auto const now = sys::uptime();
-            for (auto const& [p, f] : g_gpio_handlers) {
-                f(now);
+int64_t to_ticks(std::chrono::microseconds duration) {
+    return k_us_to_ticks_ceil64(duration.count());
+}
+
+} // namespace
+
+namespace _private {
+
+/** Deadline ordered queue of outputs with running pulse, driven by single k_timer.
+ * Timer wakes up only at the nearest pulse edge and edges are switched right from timer ISR,
+ * so outputs without pulse cost nothing.
+ * Queue is binary min-heap over static array, outputs keep their heap index.
+ * Each gpio may be borrowed only once, so GPIO_COUNT entries is enough and scheduling does not allocate.
+ */
+class PulseScheduler {
+public:
+    sys::SpinLock& lock() {
+        return this->_lock;
+    }
+
+    /// Add output or update its position after deadline change. Lock must be held.
+    void schedule(DigitalOutput* output) {
+        std::size_t idx = output->_pulse_queue_idx;
+        if (!this->_contains(output)) {
+            idx = this->_size;
+            this->_size += 1;
+            this->_place(idx, output);
+        }
+        this->_restore(idx);
+        this->_rearm();
+    }
+
+    /// Remove output from queue. Lock must be held.
+    void cancel(DigitalOutput* output) {
+        if (this->_contains(output)) {
+            this->_remove_at(output->_pulse_queue_idx);
+            this->_rearm();
+        }
+    }
+
+    void on_timer() {
+        std::lock_guard<sys::SpinLock> lock(this->_lock);
+        this->_armed_deadline = std::nullopt;
+        int64_t const now = k_uptime_ticks();
+        while (this->_size > 0 && this->_heap[0]->_pulse_deadline <= now) {
+            if (this->_heap[0]->_pulse_switch()) {
+                this->_restore(0);
+            } else {
+                this->_remove_at(0);
             }
         }
-        sys::sleep(GPIO_WAIT);
+        this->_rearm();
     }
-}
 
-K_KERNEL_THREAD_DEFINE(gpio_handler_thread, GPIO_HANDLER_STACK_SIZE, gpio_handler, NULL, NULL, NULL,
-    GPIO_HANDLER_PRIO, GPIO_HANDLER_OPTIONS, 0);
+private:
+    sys::SpinLock _lock;
+    std::array<DigitalOutput*, dtb::GPIO_COUNT> _heap{};
+    std::size_t _size = 0;
+    std::optional<int64_t> _armed_deadline = std::nullopt;
+
+    bool _contains(DigitalOutput const* output) const {
+        return output->_pulse_queue_idx < this->_size && this->_heap[output->_pulse_queue_idx] == output;
+    }
+
+    void _place(std::size_t idx, DigitalOutput* output) {
+        this->_heap[idx] = output;
+        output->_pulse_queue_idx = idx;
+    }
+
+    bool _is_earlier(std::size_t a, std::size_t b) const {
+        return this->_heap[a]->_pulse_deadline < this->_heap[b]->_pulse_deadline;
+    }
+
+    void _swap(std::size_t a, std::size_t b) {
+        DigitalOutput* const output_a = this->_heap[a];
+        this->_place(a, this->_heap[b]);
+        this->_place(b, output_a);
+    }
+
+    void _restore(std::size_t idx) {
+        while (idx > 0 && this->_is_earlier(idx, (idx - 1) / 2)) {
+            this->_swap(idx, (idx - 1) / 2);
+            idx = (idx - 1) / 2;
+        }
+        while (1) {
+            std::size_t earliest = idx;
+            for (std::size_t child = 2 * idx + 1; child <= 2 * idx + 2 && child < this->_size; child++) {
+                if (this->_is_earlier(child, earliest)) {
+                    earliest = child;
+                }
+            }
+            if (earliest == idx) {
+                break;
+            }
+            this->_swap(idx, earliest);
+            idx = earliest;
+        }
+    }
+
+    void _remove_at(std::size_t idx) {
+        this->_size -= 1;
+        if (idx != this->_size) {
+            this->_place(idx, this->_heap[this->_size]);
+            this->_restore(idx);
+        }
+    }
+
+    void _rearm() {
+        if (0 == this->_size) {
+            if (this->_armed_deadline) {
+                k_timer_stop(&pulse_timer);
+                this->_armed_deadline = std::nullopt;
+            }
+        } else if (this->_armed_deadline != this->_heap[0]->_pulse_deadline) {
+            this->_armed_deadline = this->_heap[0]->_pulse_deadline;
+            k_timer_start(&pulse_timer, K_TIMEOUT_ABS_TICKS(*this->_armed_deadline), K_NO_WAIT);
+        }
+    }
+};
+
+} // namespace _private
+
+namespace {
+
+_private::PulseScheduler g_pulse_scheduler;
+
+void pulse_timer_handler([[maybe_unused]] struct k_timer* timer) {
+    g_pulse_scheduler.on_timer();
+}
 
 } // namespace
 
 DigitalOutput::DigitalOutput(uint8_t port, OutputType type, Level level) :
+    DigitalOutput(dtb::borrow_gpio(port), port, type, level)
+{
+    unwrap(this->_init());
+}
+
+DigitalOutput::DigitalOutput(dtb::gpio_spec_t spec, uint8_t port, OutputType type, Level level) :
     _port(port),
     _type(type),
     _desired_level(level),
-    _spec(dtb::borrow_gpio(port))
-{
+    _spec(std::move(spec))
+{}
+
+expected<std::unique_ptr<DigitalOutput>> DigitalOutput::new_unique(uint8_t port, OutputType type, Level level) {
+    auto spec = dtb::try_borrow_gpio(port);
+    if (!spec) {
+        return std::unexpected(spec.error());
+    }
+    std::unique_ptr<DigitalOutput> output(new (std::nothrow) DigitalOutput(std::move(*spec), port, type, level));
+    TRY_ASSERT(output, ExceptionType::NoMemory);
+    TRY(output->_init());
+    return output;
+}
+
+expected<std::shared_ptr<DigitalOutput>> DigitalOutput::new_shared(uint8_t port, OutputType type, Level level) {
+    auto output = DigitalOutput::new_unique(port, type, level);
+    if (!output) {
+        return std::unexpected(output.error());
+    }
+    return std::shared_ptr<DigitalOutput>(std::move(*output));
+}
+
+expected<void> DigitalOutput::_init() {
     gpio_flags_t flags = 0;
     if (OutputType::PushPull == this->_type) {
         flags = GPIO_PUSH_PULL;
@@ -55,19 +197,22 @@ DigitalOutput::DigitalOutput(uint8_t port, OutputType type, Level level) :
         flags = GPIO_OPEN_DRAIN;
     }
 
-    CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_OUTPUT | flags));
-    CCALL(gpio_pin_set(this->_spec->port, this->_spec->pin, level_to_int(level)));
+    this->_flags = flags;
 
-    std::lock_guard<sys::Mutex> lock(g_gpio_handlers_mutex);
-    g_gpio_handlers[port] = std::bind(&DigitalOutput::_handle, this, std::placeholders::_1);
+    TRY_CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_OUTPUT | flags));
+    TRY_CCALL(gpio_pin_set(this->_spec->port, this->_spec->pin, level_to_int(this->_desired_level)));
+    return {};
 }
 
 DigitalOutput::DigitalOutput(std::string_view label, OutputType type, Level level) :
     DigitalOutput(dtb::find_gpio_idx_by_label(label), type, level) {}
 
 DigitalOutput::~DigitalOutput() {
-    std::lock_guard<sys::Mutex> lock(g_gpio_handlers_mutex);
-    g_gpio_handlers.erase(this->_port);
+    {
+        std::lock_guard<sys::SpinLock> lock(g_pulse_scheduler.lock());
+        g_pulse_scheduler.cancel(this);
+    }
+    this->_pulse_stop_hw();
     gpio_pin_configure(this->_spec->port, this->_spec->pin, DEINIT_GPIO_MODE);
 }
 
@@ -81,11 +226,29 @@ void DigitalOutput::_set_level(Level level) noexcept {
     CCALL_UNTIL(gpio_pin_set(this->_spec->port, this->_spec->pin, level_to_int(level)));
 }
 
-void DigitalOutput::pulse_start(std::chrono::milliseconds t_low, std::chrono::milliseconds t_high,
-    std::optional<std::size_t> count, Level first_level)
+void DigitalOutput::_pulse_set_level(Level level) noexcept {
+    // Runs under pulse scheduler lock or in timer ISR, failed set is counted instead of retried.
+    if (0 != gpio_pin_set(this->_spec->port, this->_spec->pin, level_to_int(level))) {
+        this->_pulse_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DigitalOutput::pulse_start(std::chrono::microseconds t_low, std::chrono::microseconds t_high,
+    std::optional<std::size_t> count, Level first_level, PulseMode mode)
 {
+    // Zero half-period would keep pulse deadline at now and pulse scheduler would loop in timer ISR forever.
+    ASSERT(t_low.count() > 0 && t_high.count() > 0, ExceptionType::InvalidArgument,
+        "Pulse durations must be positive on port ", static_cast<int>(this->_port));
     if (!count || *count > 0) {
         std::lock_guard<sys::Mutex> lock(this->_mutex);
+        bool const is_hw = PulseMode::Software != mode && !count && this->_pulse_start_hw(t_low, t_high, first_level);
+        ASSERT(is_hw || PulseMode::Hardware != mode, ExceptionType::NoDev,
+            "Pulse train can't be generated by timer on port ", static_cast<int>(this->_port));
+        if (!is_hw) {
+            this->_pulse_stop_hw();
+        }
+
+        std::lock_guard<sys::SpinLock> pulse_lock(g_pulse_scheduler.lock());
         this->_pulse_t_low = t_low;
         this->_pulse_t_high = t_high;
         if (count) {
@@ -96,53 +259,169 @@ void DigitalOutput::pulse_start(std::chrono::milliseconds t_low, std::chrono::mi
         }
         this->_pulse_first_level = first_level;
         this->_pulse_state = first_level;
-        this->_set_level(first_level);
-        this->_tl_pulse_sw = sys::uptime();
+        this->_events.clear(EVENT_PULSE_END);
+        if (is_hw) {
+            g_pulse_scheduler.cancel(this);
+        } else {
+            this->_pulse_set_level(first_level);
+            this->_pulse_origin = k_uptime_ticks();
+            this->_pulse_elapsed = Level::High == first_level ? t_high : t_low;
+            this->_pulse_deadline = this->_pulse_origin + to_ticks(this->_pulse_elapsed);
+            g_pulse_scheduler.schedule(this);
+        }
     }
 }
 
 void DigitalOutput::pulse_stop() {
     std::lock_guard<sys::Mutex> lock(this->_mutex);
+    this->_pulse_stop_hw();
+    std::lock_guard<sys::SpinLock> pulse_lock(g_pulse_scheduler.lock());
+    g_pulse_scheduler.cancel(this);
     this->_pulse_state = std::nullopt;
-    this->_set_level(this->_desired_level);
+    this->_pulse_set_level(this->_desired_level);
+    this->_events.post(EVENT_PULSE_END);
+    this->_listeners.notify(0);
 }
 
-void DigitalOutput::wait_pulse_end() const {
-    while (this->is_pulse_run()) {
-        sys::sleep(GPIO_WAIT);
+bool DigitalOutput::_pulse_start_hw(std::chrono::microseconds t_low, std::chrono::microseconds t_high,
+    Level first_level)
+{
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+    auto const pwm = dtb::gpio_pwm(this->_port);
+    if (!pwm) {
+        return false;
+    }
+
+    using ns = std::chrono::nanoseconds;
+    uint64_t const period_ns = std::chrono::duration_cast<ns>(t_low + t_high).count();
+    if (period_ns > UINT32_MAX) {
+        return false;
+    }
+
+    // Timer period starts from active phase, so for low first level active phase is inverted.
+    // Active low gpio inverts levels as gpio_pin_set() does.
+    pwm_flags_t flags = pwm->spec.flags;
+    uint64_t pulse_ns = std::chrono::duration_cast<ns>(t_high).count();
+    if (Level::Low == first_level) {
+        flags ^= PWM_POLARITY_INVERTED;
+        pulse_ns = std::chrono::duration_cast<ns>(t_low).count();
+    }
+    if (this->_spec->dt_flags & GPIO_ACTIVE_LOW) {
+        flags ^= PWM_POLARITY_INVERTED;
+    }
+
+    if (0 != pwm_set(pwm->spec.dev, pwm->spec.channel, period_ns, pulse_ns, flags)) {
+        return false;
+    }
+    if (!this->_is_pulse_hw) {
+        if (0 != pinctrl_apply_state(pwm->pinctrl, PINCTRL_STATE_DEFAULT)) {
+            pwm_set(pwm->spec.dev, pwm->spec.channel, period_ns, 0, pwm->spec.flags);
+            return false;
+        }
+        this->_is_pulse_hw = true;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void DigitalOutput::_pulse_stop_hw() noexcept {
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+    if (this->_is_pulse_hw) {
+        auto const pwm = dtb::gpio_pwm(this->_port);
+        if (pwm) {
+            pwm_set(pwm->spec.dev, pwm->spec.channel, pwm->spec.period, 0, pwm->spec.flags);
+        }
+        // Return pin from timer alternate function back to gpio.
+        gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_OUTPUT | this->_flags);
+        this->_is_pulse_hw = false;
+    }
+#endif
+}
+
+bool DigitalOutput::wait_pulse_end(sys::timeout_t timeout) const {
+    sys::Deadline const deadline(timeout);
+    while (1) {
+        this->_events.clear(EVENT_PULSE_END);
+        if (!this->is_pulse_run()) {
+            return true;
+        }
+        if (0 == this->_events.wait(EVENT_PULSE_END, deadline)) {
+            return !this->is_pulse_run();
+        }
     }
 }
 
 bool DigitalOutput::is_pulse_run() const {
     std::lock_guard<sys::Mutex> lock(this->_mutex);
+    std::lock_guard<sys::SpinLock> pulse_lock(g_pulse_scheduler.lock());
     return this->_pulse_state.has_value();
 }
 
-void DigitalOutput::_handle(std::chrono::milliseconds now) noexcept {
-    if (this->_mutex.try_lock(GPIO_HANDLER_LOCK_TIMEOUT)) {
-        if (this->_pulse_state.has_value()) {
-            std::chrono::milliseconds duration = this->_pulse_t_low;
-            if (Level::High == this->_pulse_state) {
-                duration = this->_pulse_t_high;
-            }
-            bool const is_time_to_sw = (now - this->_tl_pulse_sw) >= duration;
-            if (is_time_to_sw) {
-                if (!this->_is_pulse_continuous && this->_pulse_state != this->_pulse_first_level) {
-                    this->_pulse_remain -= 1;
-                }
-                if (!this->_is_pulse_continuous && 0 == this->_pulse_remain) {
-                    this->_pulse_state = std::nullopt;
-                } else {
-                    this->_tl_pulse_sw = now;
-                    this->_pulse_state = !*this->_pulse_state;
-                    this->_set_level(*this->_pulse_state);
-                }
-            }
-        }
+bool DigitalOutput::is_pulse_hardware() const {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    return this->_is_pulse_hw;
+}
+
+void DigitalOutput::add_listener(sys::Listener* listener) const {
+    std::lock_guard<sys::SpinLock> lock(g_pulse_scheduler.lock());
+    this->_listeners.add(listener);
+}
+
+void DigitalOutput::remove_listener(sys::Listener* listener) const {
+    std::lock_guard<sys::SpinLock> lock(g_pulse_scheduler.lock());
+    this->_listeners.remove(listener);
+}
+
+bool DigitalOutput::_pulse_switch() noexcept {
+    if (!this->_is_pulse_continuous && this->_pulse_state != this->_pulse_first_level) {
+        this->_pulse_remain -= 1;
+    }
+    if (!this->_is_pulse_continuous && 0 == this->_pulse_remain) {
+        this->_pulse_state = std::nullopt;
+        this->_events.post(EVENT_PULSE_END);
+        this->_listeners.notify(0);
+        return false;
+    }
+
+    this->_pulse_state = !*this->_pulse_state;
+    this->_pulse_set_level(*this->_pulse_state);
+    // Edge time is kept exact since pulse start and rounded to tick once, so neither timer latency
+    // nor tick rounding accumulates and frequency is exact on average.
+    this->_pulse_elapsed += Level::High == *this->_pulse_state ? this->_pulse_t_high : this->_pulse_t_low;
+    this->_pulse_deadline = this->_pulse_origin + to_ticks(this->_pulse_elapsed);
+    return true;
+}
+
+PulseDoneAwaiter::PulseDoneAwaiter(DigitalOutput const& output) :
+    _output(output)
+{
+    this->on_event = PulseDoneAwaiter::_on_event;
+}
 
-        this->_mutex.unlock();
+PulseDoneAwaiter::~PulseDoneAwaiter() {
+    if (this->_scheduler) {
+        this->_output.remove_listener(this);
     }
 }
 
+bool PulseDoneAwaiter::await_suspend(sys::Task::handle_t handle) {
+    this->handle = handle;
+    std::lock_guard<sys::SpinLock> lock(g_pulse_scheduler.lock());
+    if (!this->_output._pulse_state) {
+        return false;
+    }
+    this->_scheduler = handle.promise().scheduler;
+    this->_output._listeners.add(this);
+    return true;
+}
+
+bool PulseDoneAwaiter::_on_event(sys::Listener* listener, [[maybe_unused]] uint32_t value) {
+    auto* const self = static_cast<PulseDoneAwaiter*>(listener);
+    self->_scheduler->wake(self);
+    return false;
+}
+
+}
 }
-}
\ No newline at end of file
@@ -9,44 +9,36 @@
  * - Device may not use any pins.
  * 
  * When device borrowing request:
- * - Check for device is not already used.
- * - Check for all device ports is not already used.
  * - Get raw device from device tree.
- * - Mark requested device as used.
- * - Mark used by device ports as used.
+ * - Check for device is not already used and mark it as used.
+ * - Check for all device ports is not already used and mark them as used.
  * 
  * When device dropped:
- * - Mark device as unused.
  * - Mark used by device ports as unused.
+ * - Mark device as unused.
+ *
+ * Device-ports table is generated from devicetree `ports` property at compile time (see dtb.hpp).
+ * Devices and ports in use are atomic bitsets, so check-and-mark is compare-and-swap of a bitset word
+ * without any global lock.
  */
 
 #include "dtb.hpp"
 #include "macro.hpp"
-#include <mlplc/sys/mutex.hpp>
 
 #include <array>
-#include <vector>
-#include <unordered_map>
-#include <mutex>
+#include <atomic>
 #include <optional>
 #include <cstdint>
 
-template <>
-struct std::hash<mlplc::dtb::DeviceId>
-{
-    std::size_t operator()(mlplc::dtb::DeviceId const& self) const {
-        uint64_t const raw = (static_cast<uint8_t>(self.type) << 8) | self.idx;
-        return static_cast<std::size_t>(raw);
-    }
-};
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+// Gpio with timer channel has own pin state for switching pin to timer alternate function.
+#define DEFINE_GPIO_PINCTRL(node_id) IF_ENABLED(DT_NODE_HAS_PROP(node_id, pwms), (PINCTRL_DT_DEFINE(node_id);))
+DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), DEFINE_GPIO_PINCTRL)
+#endif
 
 namespace mlplc {
 namespace dtb {
 
-bool operator== (DeviceId const& self, DeviceId const& other) {
-    return self.idx == other.idx && self.type == other.type;
-}
-
 std::ostream& operator<< (std::ostream& os, DeviceId const& dev_id) {
     os << magic_enum::enum_name(dev_id.type) << "_" << static_cast<int>(dev_id.idx);
     return os;
@@ -54,68 +46,113 @@ std::ostream& operator<< (std::ostream& os, DeviceId const& dev_id) {
 
 namespace {
 
-template <typename T>
-struct DtSpec {
-    T dt_spec;
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+struct GpioPwmSpec {
     uint8_t idx;
-    std::string_view label;
+    GpioPwm pwm;
 };
 
-std::unordered_map<DeviceId, ports_t> const DEVICE_PORTS_MAP = {
-    // TODO:
-    {{DeviceType::Gpio, 0}, ports_mask({0})},
-};
+#define COUNT_GPIO_PWM(node_id) + DT_NODE_HAS_PROP(node_id, pwms)
+#define PRINT_GPIO_PWM_SPEC(node_id) IF_ENABLED(DT_NODE_HAS_PROP(node_id, pwms), \
+    (GpioPwmSpec {DT_PROP(node_id, idx), {PWM_DT_SPEC_GET(node_id), PINCTRL_DT_DEV_CONFIG_GET(node_id)}},))
 
-#define PRINT_GPIO_DT_SPEC(node_id) DtSpec {gpio_dt_spec GPIO_DT_SPEC_GET(node_id, gpios), DT_PROP(node_id, idx), DT_PROP(node_id, label)},
+constexpr std::size_t GPIO_PWM_COUNT = 0 DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), COUNT_GPIO_PWM);
 
-std::array<DtSpec<struct gpio_dt_spec>, GPIO_COUNT> const GPIOS = {
-    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), PRINT_GPIO_DT_SPEC)
+std::array<GpioPwmSpec, GPIO_PWM_COUNT> const GPIO_PWMS = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), PRINT_GPIO_PWM_SPEC)
 };
+#endif
 
-static sys::Mutex mutex;
-std::unordered_map<DeviceId, bool> device_in_use;
-
-void assert_device_borrowing(DeviceId dev_id) {
-    ASSERT(!is_dev_in_use(dev_id), ExceptionType::DeviceAlreadyInUse, dev_id);
+/** Bitset, where each word is changed by single compare-and-swap.
+ * Set of bits which lay in one word is acquired atomically, multi-word set is acquired
+ * word by word and rolled back on conflict.
+ */
+template <std::size_t N>
+class AtomicBits {
+public:
+    bool try_set(Bits<N> const& bits) {
+        auto const& mask = bits.words();
+        for (std::size_t w = 0; w < Bits<N>::WORDS; w++) {
+            if (0 == mask[w]) {
+                continue;
+            }
+            uint32_t current = this->_words[w].load(std::memory_order_relaxed);
+            do {
+                if (current & mask[w]) {
+                    for (std::size_t r = 0; r < w; r++) {
+                        this->_words[r].fetch_and(~mask[r], std::memory_order_release);
+                    }
+                    return false;
+                }
+            } while (!this->_words[w].compare_exchange_weak(current, current | mask[w],
+                std::memory_order_acq_rel, std::memory_order_relaxed));
+        }
+        return true;
+    }
 
-    // Check ports overlapping.
-    if (DEVICE_PORTS_MAP.contains(dev_id)) {
-        // If device exists in device-ports map - this mean that it may use ports.
-        auto overlapped_dev = dev_that_ports_overlap_with(DEVICE_PORTS_MAP.at(dev_id));
-        ASSERT(!overlapped_dev, ExceptionType::PortAlreadyInUse, *overlapped_dev);
+    void clear(Bits<N> const& bits) {
+        auto const& mask = bits.words();
+        for (std::size_t w = 0; w < Bits<N>::WORDS; w++) {
+            if (mask[w]) {
+                this->_words[w].fetch_and(~mask[w], std::memory_order_release);
+            }
+        }
     }
-}
 
-void on_dev_drop(DeviceId dev_id) {
-    std::lock_guard<sys::Mutex> lock(mutex);
-    if (device_in_use.contains(dev_id)) {
-        device_in_use[dev_id] = false;
+    bool test(std::size_t bit) const {
+        return bit < N && (this->_words[bit / 32].load(std::memory_order_acquire) & (uint32_t(1) << (bit % 32)));
     }
+
+private:
+    std::array<std::atomic<uint32_t>, Bits<N>::WORDS> _words{};
+};
+
+AtomicBits<_private::DEVICE_COUNT> devices_in_use;
+AtomicBits<PORT_COUNT> ports_in_use;
+
+Bits<_private::DEVICE_COUNT> device_bit(std::size_t pos) {
+    Bits<_private::DEVICE_COUNT> bits;
+    bits.set(pos);
+    return bits;
 }
 
-template <typename T, std::size_t N>
-std::optional<DtSpec<T>> find_dt_spec_by_idx(std::array<DtSpec<T>, N> const& array, uint8_t idx) {
-    for (auto const& d : array) {
-        if (d.idx == idx) {
-            return d;
-        }
+/// Mark device and its ports as used, or fail if device or any of its ports is already in use.
+expected<void> try_acquire_device(DeviceId dev_id) {
+    auto const pos = _private::device_pos(dev_id);
+    TRY_ASSERT(pos, ExceptionType::NoDev);
+
+    TRY_ASSERT(devices_in_use.try_set(device_bit(*pos)), ExceptionType::DeviceAlreadyInUse);
+    if (!ports_in_use.try_set(_private::DEVICE_PORTS_MAP[*pos])) {
+        devices_in_use.clear(device_bit(*pos));
+        return std::unexpected(Error{ExceptionType::PortAlreadyInUse});
     }
-    return std::nullopt;
+    return {};
 }
 
-template <typename T, std::size_t N>
-std::optional<uint8_t> find_idx_by_label(std::array<DtSpec<T>, N> const& array, std::string_view label) {
-    for (auto const& d : array) {
-        if (d.label == label) {
-            return d.idx;
+/// Throwing variant of try_acquire_device(), exception names the device which holds the ports.
+void acquire_device(DeviceId dev_id) {
+    auto const result = try_acquire_device(dev_id);
+    if (!result) {
+        if (ExceptionType::PortAlreadyInUse == result.error().type) {
+            auto const overlapped_dev = dev_that_ports_overlap_with(*dev_ports(dev_id));
+            ASSERT(!overlapped_dev, ExceptionType::PortAlreadyInUse, *overlapped_dev);
         }
+        // Port owner has just dropped the ports.
+        ASSERT(false, result.error().type, dev_id);
     }
-    return std::nullopt;
 }
 
 }
 
 
+void release(DeviceId dev_id) {
+    auto const pos = _private::device_pos(dev_id);
+    if (pos && devices_in_use.test(*pos)) {
+        ports_in_use.clear(_private::DEVICE_PORTS_MAP[*pos]);
+        devices_in_use.clear(device_bit(*pos));
+    }
+}
+
 std::optional<DeviceId> port_owner(uint8_t port) {
     ports_t const port_mask = ports_mask({port});
 
@@ -123,13 +160,9 @@ std::optional<DeviceId> port_owner(uint8_t port) {
 }
 
 std::optional<DeviceId> dev_that_ports_overlap_with(ports_t ports_mask) {
-    std::lock_guard<sys::Mutex> lock(mutex);
-    for (auto const& [dev_id, is_used] : device_in_use) {
-        if (is_used) {
-            ports_t const dev_ports = DEVICE_PORTS_MAP.at(dev_id);
-            if (dev_ports & ports_mask) {
-                return dev_id;
-            }
+    for (std::size_t d = 0; d < _private::DEVICE_COUNT; d++) {
+        if (devices_in_use.test(d) && (_private::DEVICE_PORTS_MAP[d] & ports_mask)) {
+            return _private::DEVICES[d].id;
         }
     }
 
@@ -137,33 +170,97 @@ std::optional<DeviceId> dev_that_ports_overlap_with(ports_t ports_mask) {
 }
 
 std::optional<ports_t> dev_ports_in_use(DeviceId dev_id) {
-    std::lock_guard<sys::Mutex> lock(mutex);
-    if (device_in_use.contains(dev_id) && device_in_use.at(dev_id)) {
-        return DEVICE_PORTS_MAP.at(dev_id);
+    if (is_dev_in_use(dev_id)) {
+        return dev_ports(dev_id);
     }
 
     return std::nullopt;
 }
 
 bool is_dev_in_use(DeviceId dev_id) {
-    std::lock_guard<sys::Mutex> lock(mutex);
-    return device_in_use.contains(dev_id) && device_in_use.at(dev_id);
+    auto const pos = _private::device_pos(dev_id);
+    return pos && devices_in_use.test(*pos);
 }
 
 gpio_spec_t borrow_gpio(uint8_t idx) {
     DeviceId const dev_id = DeviceId{DeviceType::Gpio, idx};
-    assert_device_borrowing(dev_id);
-    auto result = find_dt_spec_by_idx<struct gpio_dt_spec, GPIO_COUNT>(GPIOS, idx);
-    ASSERT(result, ExceptionType::NoDev, "Gpio not found: ", idx);
-    return gpio_spec_t(new gpio_dt_spec(result->dt_spec), Deleter<struct gpio_dt_spec>(dev_id, on_dev_drop));
+    auto const pos = _private::device_pos(dev_id);
+    ASSERT(pos, ExceptionType::NoDev, "Gpio not found: ", static_cast<int>(idx));
+    acquire_device(dev_id);
+    return gpio_spec_t(&_private::GPIOS[*pos].dt_spec, dev_id);
+}
+
+expected<gpio_spec_t> try_borrow_gpio(uint8_t idx) {
+    DeviceId const dev_id = DeviceId{DeviceType::Gpio, idx};
+    auto const pos = _private::device_pos(dev_id);
+    TRY_ASSERT(pos, ExceptionType::NoDev);
+    TRY(try_acquire_device(dev_id));
+    return gpio_spec_t(&_private::GPIOS[*pos].dt_spec, dev_id);
 }
 
 uint8_t find_gpio_idx_by_label(std::string_view label) {
-    auto const result = find_idx_by_label<struct gpio_dt_spec, GPIO_COUNT>(GPIOS, label);
+    auto const result = _private::find_idx_by_label(_private::GPIO_LABELS, label);
     ASSERT(result, ExceptionType::NoDev, label);
     return *result;
 }
 
+#if defined(CONFIG_ADC)
+adc_spec_t borrow_adc(uint8_t idx) {
+    DeviceId const dev_id = DeviceId{DeviceType::Analog, idx};
+    auto const pos = _private::device_pos(dev_id);
+    ASSERT(pos, ExceptionType::NoDev, "Analog channel not found: ", static_cast<int>(idx));
+    acquire_device(dev_id);
+    return adc_spec_t(&_private::ADCS[*pos - GPIO_COUNT].dt_spec, dev_id);
+}
+
+expected<adc_spec_t> try_borrow_adc(uint8_t idx) {
+    DeviceId const dev_id = DeviceId{DeviceType::Analog, idx};
+    auto const pos = _private::device_pos(dev_id);
+    TRY_ASSERT(pos, ExceptionType::NoDev);
+    TRY(try_acquire_device(dev_id));
+    return adc_spec_t(&_private::ADCS[*pos - GPIO_COUNT].dt_spec, dev_id);
+}
+
+uint8_t find_adc_idx_by_label(std::string_view label) {
+    auto const result = _private::find_idx_by_label(_private::ADC_LABELS, label);
+    ASSERT(result, ExceptionType::NoDev, label);
+    return *result;
+}
+#endif
+
+serial_spec_t borrow_serial(uint8_t idx) {
+    DeviceId const dev_id = DeviceId{DeviceType::Serial, idx};
+    auto const pos = _private::device_pos(dev_id);
+    ASSERT(pos, ExceptionType::NoDev, "Serial port not found: ", static_cast<int>(idx));
+    acquire_device(dev_id);
+    return serial_spec_t(&_private::SERIALS[*pos - GPIO_COUNT - ADC_COUNT].dt_spec, dev_id);
+}
+
+expected<serial_spec_t> try_borrow_serial(uint8_t idx) {
+    DeviceId const dev_id = DeviceId{DeviceType::Serial, idx};
+    auto const pos = _private::device_pos(dev_id);
+    TRY_ASSERT(pos, ExceptionType::NoDev);
+    TRY(try_acquire_device(dev_id));
+    return serial_spec_t(&_private::SERIALS[*pos - GPIO_COUNT - ADC_COUNT].dt_spec, dev_id);
+}
+
+uint8_t find_serial_idx_by_label(std::string_view label) {
+    auto const result = _private::find_idx_by_label(_private::SERIAL_LABELS, label);
+    ASSERT(result, ExceptionType::NoDev, label);
+    return *result;
+}
+
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+std::optional<GpioPwm> gpio_pwm(uint8_t idx) {
+    for (auto const& p : GPIO_PWMS) {
+        if (p.idx == idx && pwm_is_ready_dt(&p.pwm.spec)) {
+            return p.pwm;
+        }
+    }
+    return std::nullopt;
+}
+#endif
+
 namespace _private {
 
 };
@@ -1,71 +1,427 @@
 #pragma once
 
 #include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/uart.h>
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/drivers/pinctrl.h>
+#endif
+#if defined(CONFIG_ADC)
+#include <zephyr/drivers/adc.h>
+#endif
 
 #include <optional>
 #include <string>
 #include <cstdint>
 #include <expected>
-#include <memory>
-#include <functional>
-#include <unordered_map>
+#include <utility>
+#include <array>
+#include <initializer_list>
 #include <string_view>
 
 namespace mlplc {
 namespace dtb {
 
-namespace _private {
+enum class DeviceType : uint8_t {
+    Gpio,
+    Serial,
+    Analog,
+};
 
+struct DeviceId {
+    DeviceType type;
+    uint8_t idx;
+
+    constexpr bool operator== (DeviceId const& other) const = default;
 };
 
-using ports_t = uint64_t;
+/// Fixed size bitset usable in constant expressions. Bits above N are ignored.
+template <std::size_t N>
+class Bits {
+public:
+    static constexpr std::size_t WORDS = N > 0 ? (N + 31) / 32 : 1;
+
+    using words_t = std::array<uint32_t, WORDS>;
+
+    constexpr Bits() = default;
+
+    constexpr Bits(std::initializer_list<uint8_t const> bits) {
+        for (auto b : bits) {
+            this->set(b);
+        }
+    }
+
+    constexpr void set(std::size_t bit) {
+        if (bit < N) {
+            this->_words[bit / 32] |= uint32_t(1) << (bit % 32);
+        }
+    }
+
+    constexpr bool test(std::size_t bit) const {
+        return bit < N && (this->_words[bit / 32] & (uint32_t(1) << (bit % 32)));
+    }
+
+    constexpr bool any() const {
+        for (auto w : this->_words) {
+            if (w) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr explicit operator bool() const {
+        return this->any();
+    }
+
+    constexpr Bits operator& (Bits const& other) const {
+        Bits result;
+        for (std::size_t w = 0; w < WORDS; w++) {
+            result._words[w] = this->_words[w] & other._words[w];
+        }
+        return result;
+    }
+
+    constexpr bool operator== (Bits const& other) const = default;
+
+    constexpr words_t const& words() const {
+        return this->_words;
+    }
+
+private:
+    words_t _words{};
+};
 
 constexpr std::size_t GPIO_COUNT = DT_CHILD_NUM_STATUS_OKAY(DT_NODELABEL(mlplc_gpios));
 
-constexpr ports_t ports_mask(std::initializer_list<uint8_t const> ports_list) {
-    ports_t ports_mask = 0;
+// Analog channels are optional, board may have no `mlplc_adcs` node.
+#if defined(CONFIG_ADC) && DT_NODE_EXISTS(DT_NODELABEL(mlplc_adcs))
+#define MLPLC_DTB_FOREACH_ADC(fn) DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_adcs), fn)
+#else
+#define MLPLC_DTB_FOREACH_ADC(fn)
+#endif
+
+#define MLPLC_DTB_ONE(node_id) + 1
+
+constexpr std::size_t ADC_COUNT = 0 MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_ONE);
+
+// Same for serial ports, `mlplc_serials` node.
+#if defined(CONFIG_SERIAL) && DT_NODE_EXISTS(DT_NODELABEL(mlplc_serials))
+#define MLPLC_DTB_FOREACH_SERIAL(fn) DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_serials), fn)
+#else
+#define MLPLC_DTB_FOREACH_SERIAL(fn)
+#endif
+
+constexpr std::size_t SERIAL_COUNT = 0 MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_ONE);
 
-    for (auto p : ports_list) {
-        ports_mask |= 1 << p;
+/// UART of serial port, pins are switched to UART by its own pinctrl.
+struct serial_dt_spec {
+    struct device const* dev;
+};
+
+/// Compile time string, usable as template argument: DigitalOutput::of<"LED_R">().
+template <std::size_t N>
+struct Label {
+    constexpr Label(char const (&str)[N]) {
+        for (std::size_t i = 0; i < N; i++) {
+            this->chars[i] = str[i];
+        }
     }
 
-    return ports_mask;
-}
+    constexpr std::string_view view() const {
+        return std::string_view(this->chars, N - 1);
+    }
 
-enum class DeviceType : uint8_t {
-    Gpio,
-    Serial,
+    char chars[N]{};
 };
 
-struct DeviceId {
-    DeviceType type;
+namespace _private {
+
+template <typename T>
+struct DtSpec {
+    T dt_spec;
     uint8_t idx;
 };
 
+/// Labels are kept apart from specs, so they are not linked in when labels are resolved at compile time.
+struct DtLabel {
+    uint8_t idx;
+    std::string_view label;
+};
+
+#define MLPLC_DTB_GPIO_DT_SPEC(node_id) DtSpec<struct gpio_dt_spec> {GPIO_DT_SPEC_GET(node_id, gpios), DT_PROP(node_id, idx)},
+#define MLPLC_DTB_LABEL(node_id) DtLabel {DT_PROP(node_id, idx), DT_PROP(node_id, label)},
+
+inline constexpr std::array<DtSpec<struct gpio_dt_spec>, GPIO_COUNT> GPIOS = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), MLPLC_DTB_GPIO_DT_SPEC)
+};
+
+inline constexpr std::array<DtLabel, GPIO_COUNT> GPIO_LABELS = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), MLPLC_DTB_LABEL)
+};
+
+#if defined(CONFIG_ADC)
+#define MLPLC_DTB_ADC_DT_SPEC(node_id) DtSpec<struct adc_dt_spec> {ADC_DT_SPEC_GET(node_id), DT_PROP(node_id, idx)},
+
+inline constexpr std::array<DtSpec<struct adc_dt_spec>, ADC_COUNT> ADCS = {
+    MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_ADC_DT_SPEC)
+};
+
+inline constexpr std::array<DtLabel, ADC_COUNT> ADC_LABELS = {
+    MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_LABEL)
+};
+#endif
+
+#define MLPLC_DTB_SERIAL_DT_SPEC(node_id) \
+    DtSpec<struct serial_dt_spec> {{DEVICE_DT_GET(DT_PHANDLE(node_id, uart))}, DT_PROP(node_id, idx)},
+
+inline constexpr std::array<DtSpec<struct serial_dt_spec>, SERIAL_COUNT> SERIALS = {
+    MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_SERIAL_DT_SPEC)
+};
+
+inline constexpr std::array<DtLabel, SERIAL_COUNT> SERIAL_LABELS = {
+    MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_LABEL)
+};
+
+template <std::size_t N>
+constexpr std::optional<uint8_t> find_idx_by_label(std::array<DtLabel, N> const& labels, std::string_view label) {
+    for (auto const& l : labels) {
+        if (l.label == label) {
+            return l.idx;
+        }
+    }
+    return std::nullopt;
+}
+
+template <typename T, std::size_t N>
+constexpr std::optional<DtSpec<T>> find_dt_spec_by_idx(std::array<DtSpec<T>, N> const& array, uint8_t idx) {
+    for (auto const& d : array) {
+        if (d.idx == idx) {
+            return d;
+        }
+    }
+    return std::nullopt;
+}
+
+/// Device described in devicetree, its ports are stored in flat DEVICE_PORTS array one by one.
+struct DeviceDesc {
+    DeviceId id;
+    uint8_t ports_count;
+};
+
+#define MLPLC_DTB_PORTS_LEN(node_id) + DT_PROP_LEN(node_id, ports)
+#define MLPLC_DTB_PORT(node_id, prop, i) DT_PROP_BY_IDX(node_id, prop, i),
+#define MLPLC_DTB_PORTS(node_id) DT_FOREACH_PROP_ELEM(node_id, ports, MLPLC_DTB_PORT)
+#define MLPLC_DTB_GPIO_DEVICE(node_id) DeviceDesc {{DeviceType::Gpio, DT_PROP(node_id, idx)}, DT_PROP_LEN(node_id, ports)},
+#define MLPLC_DTB_ADC_DEVICE(node_id) DeviceDesc {{DeviceType::Analog, DT_PROP(node_id, idx)}, DT_PROP_LEN(node_id, ports)},
+#define MLPLC_DTB_SERIAL_DEVICE(node_id) DeviceDesc {{DeviceType::Serial, DT_PROP(node_id, idx)}, DT_PROP_LEN(node_id, ports)},
+
+constexpr std::size_t DEVICE_COUNT = GPIO_COUNT + ADC_COUNT + SERIAL_COUNT;
+
+constexpr std::size_t DEVICE_PORTS_COUNT = 0
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), MLPLC_DTB_PORTS_LEN)
+    MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_PORTS_LEN)
+    MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_PORTS_LEN);
+
+inline constexpr std::array<DeviceDesc, DEVICE_COUNT> DEVICES = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), MLPLC_DTB_GPIO_DEVICE)
+    MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_ADC_DEVICE)
+    MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_SERIAL_DEVICE)
+};
+
+inline constexpr std::array<uint8_t, DEVICE_PORTS_COUNT> DEVICE_PORTS = {
+    DT_FOREACH_CHILD_STATUS_OKAY(DT_NODELABEL(mlplc_gpios), MLPLC_DTB_PORTS)
+    MLPLC_DTB_FOREACH_ADC(MLPLC_DTB_PORTS)
+    MLPLC_DTB_FOREACH_SERIAL(MLPLC_DTB_PORTS)
+};
+
+constexpr std::size_t port_count() {
+    std::size_t count = 0;
+    for (auto p : DEVICE_PORTS) {
+        count = p + 1u > count ? p + 1u : count;
+    }
+    return count;
+}
+
+} // namespace _private
+
+/// Count of ports, i.e. max port number used in devicetree + 1.
+constexpr std::size_t PORT_COUNT = _private::port_count();
+
+using ports_t = Bits<PORT_COUNT>;
+
+constexpr ports_t ports_mask(std::initializer_list<uint8_t const> ports_list) {
+    return ports_t(ports_list);
+}
+
+namespace _private {
+
+constexpr std::array<ports_t, DEVICE_COUNT> make_device_ports() {
+    std::array<ports_t, DEVICE_COUNT> result{};
+    std::size_t offset = 0;
+    for (std::size_t d = 0; d < DEVICE_COUNT; d++) {
+        for (std::size_t p = 0; p < DEVICES[d].ports_count; p++) {
+            result[d].set(DEVICE_PORTS[offset + p]);
+        }
+        offset += DEVICES[d].ports_count;
+    }
+    return result;
+}
+
+/// Ports of each device, position is the same as in DEVICES.
+inline constexpr std::array<ports_t, DEVICE_COUNT> DEVICE_PORTS_MAP = make_device_ports();
+
+constexpr std::size_t DEVICE_TYPE_COUNT = 3;
+constexpr uint8_t NO_DEVICE = 0xff;
+
+constexpr auto make_device_positions() {
+    std::array<std::array<uint8_t, 256>, DEVICE_TYPE_COUNT> result{};
+    for (auto& type : result) {
+        type.fill(NO_DEVICE);
+    }
+    for (std::size_t d = 0; d < DEVICE_COUNT; d++) {
+        result[static_cast<uint8_t>(DEVICES[d].id.type)][DEVICES[d].id.idx] = d;
+    }
+    return result;
+}
+
+/// Position of device in DEVICES by device type and index - O(1) device lookup.
+inline constexpr auto DEVICE_POSITIONS = make_device_positions();
+
+static_assert(DEVICE_COUNT < NO_DEVICE, "Too many devices in devicetree");
+
+constexpr std::optional<std::size_t> device_pos(DeviceId dev_id) {
+    uint8_t const pos = DEVICE_POSITIONS[static_cast<uint8_t>(dev_id.type)][dev_id.idx];
+    if (NO_DEVICE == pos) {
+        return std::nullopt;
+    }
+    return pos;
+}
+
+constexpr bool is_gpios_ordered_as_devices() {
+    for (std::size_t i = 0; i < GPIO_COUNT; i++) {
+        if (DEVICES[i].id != DeviceId{DeviceType::Gpio, GPIOS[i].idx}) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Gpio device position is its position in GPIOS, so borrowed gpio handle is found in O(1).
+static_assert(is_gpios_ordered_as_devices(), "Gpio devices must go first in DEVICES, in GPIOS order");
+
+#if defined(CONFIG_ADC)
+constexpr bool is_adcs_ordered_as_devices() {
+    for (std::size_t i = 0; i < ADC_COUNT; i++) {
+        if (DEVICES[GPIO_COUNT + i].id != DeviceId{DeviceType::Analog, ADCS[i].idx}) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Same for analog channels, they follow gpios.
+static_assert(is_adcs_ordered_as_devices(), "Analog devices must follow gpios in DEVICES, in ADCS order");
+#endif
+
+constexpr bool is_serials_ordered_as_devices() {
+    for (std::size_t i = 0; i < SERIAL_COUNT; i++) {
+        if (DEVICES[GPIO_COUNT + ADC_COUNT + i].id != DeviceId{DeviceType::Serial, SERIALS[i].idx}) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Serial ports go last.
+static_assert(is_serials_ordered_as_devices(), "Serial devices must follow analog devices in DEVICES, in SERIALS order");
+
+} // namespace _private
+
+/// Ports used by device, known at compile time.
+constexpr std::optional<ports_t> dev_ports(DeviceId dev_id) {
+    auto const pos = _private::device_pos(dev_id);
+    if (!pos) {
+        return std::nullopt;
+    }
+    return _private::DEVICE_PORTS_MAP[*pos];
+}
+
+/// Mark device and its ports as unused.
+void release(DeviceId dev_id);
+
+/** Handle of borrowed device, releases device on destruction.
+ * Points into static devicetree table and holds only pointer and device id,
+ * so borrowing and releasing do not allocate. Move-only - device has single owner.
+ */
 template <typename T>
-class Deleter {
+class Borrowed {
 public:
-    Deleter(DeviceId dev_id, std::function<void(DeviceId)> drop_cb) :
-        _dev_id(dev_id),
-        _drop_cb(drop_cb)
+    Borrowed() = default;
+
+    Borrowed(T const* dt_spec, DeviceId dev_id) :
+        _dt_spec(dt_spec),
+        _dev_id(dev_id)
     {}
 
-    ~Deleter() {}
+    Borrowed(Borrowed&& other) noexcept :
+        _dt_spec(std::exchange(other._dt_spec, nullptr)),
+        _dev_id(other._dev_id)
+    {}
+
+    Borrowed& operator= (Borrowed&& other) noexcept {
+        if (this != &other) {
+            this->reset();
+            this->_dt_spec = std::exchange(other._dt_spec, nullptr);
+            this->_dev_id = other._dev_id;
+        }
+        return *this;
+    }
+
+    ~Borrowed() {
+        this->reset();
+    }
+
+    void reset() noexcept {
+        if (this->_dt_spec) {
+            release(this->_dev_id);
+            this->_dt_spec = nullptr;
+        }
+    }
+
+    T const* get() const {
+        return this->_dt_spec;
+    }
+
+    T const* operator-> () const {
+        return this->_dt_spec;
+    }
+
+    T const& operator* () const {
+        return *this->_dt_spec;
+    }
+
+    explicit operator bool() const {
+        return nullptr != this->_dt_spec;
+    }
 
-    void operator() ([[maybe_unused]] T const* dt_spec) {
-        this->_drop_cb(this->_dev_id);
+    DeviceId dev_id() const {
+        return this->_dev_id;
     }
 
+    Borrowed(Borrowed const&) = delete;
+    Borrowed& operator= (Borrowed const&) = delete;
+
 private:
-    DeviceId _dev_id;
-    std::function<void(DeviceId)> _drop_cb;
+    T const* _dt_spec = nullptr;
+    DeviceId _dev_id{};
 };
 
-using gpio_spec_t = std::unique_ptr<struct gpio_dt_spec const, Deleter<struct gpio_dt_spec>>;
+using gpio_spec_t = Borrowed<struct gpio_dt_spec>;
 
 
 std::optional<DeviceId> port_owner(uint8_t port);
@@ -77,7 +433,69 @@ std::optional<ports_t> dev_ports_in_use(DeviceId dev_id);
 bool is_dev_in_use(DeviceId dev_id);
 
 gpio_spec_t borrow_gpio(uint8_t idx);
+/// Non-throwing borrow_gpio().
+expected<gpio_spec_t> try_borrow_gpio(uint8_t idx);
 uint8_t find_gpio_idx_by_label(std::string_view label);
 
+/// Gpio index by label, resolved at compile time. Unknown label is compile error.
+template <Label L>
+consteval uint8_t gpio_idx_of() {
+    constexpr std::optional<uint8_t> idx = _private::find_idx_by_label(_private::GPIO_LABELS, L.view());
+    static_assert(idx.has_value(), "Gpio label is not found in devicetree");
+    return idx.value_or(0);
+}
+
+template <Label L>
+consteval struct gpio_dt_spec gpio_spec_of() {
+    return _private::find_dt_spec_by_idx(_private::GPIOS, gpio_idx_of<L>())->dt_spec;
+}
+
+#if defined(CONFIG_ADC)
+/// Analog channel, described by child of `mlplc_adcs` node. Channel settings are in `channel@` node of ADC.
+using adc_spec_t = Borrowed<struct adc_dt_spec>;
+
+adc_spec_t borrow_adc(uint8_t idx);
+/// Non-throwing borrow_adc().
+expected<adc_spec_t> try_borrow_adc(uint8_t idx);
+uint8_t find_adc_idx_by_label(std::string_view label);
+
+/// Analog channel index by label, resolved at compile time. Unknown label is compile error.
+template <Label L>
+consteval uint8_t adc_idx_of() {
+    constexpr std::optional<uint8_t> idx = _private::find_idx_by_label(_private::ADC_LABELS, L.view());
+    static_assert(idx.has_value(), "Analog channel label is not found in devicetree");
+    return idx.value_or(0);
+}
+#endif
+
+/// Serial port, described by child of `mlplc_serials` node. Line settings are set by periph::Serial.
+using serial_spec_t = Borrowed<struct serial_dt_spec>;
+
+serial_spec_t borrow_serial(uint8_t idx);
+/// Non-throwing borrow_serial().
+expected<serial_spec_t> try_borrow_serial(uint8_t idx);
+uint8_t find_serial_idx_by_label(std::string_view label);
+
+/// Serial port index by label, resolved at compile time. Unknown label is compile error.
+template <Label L>
+consteval uint8_t serial_idx_of() {
+    constexpr std::optional<uint8_t> idx = _private::find_idx_by_label(_private::SERIAL_LABELS, L.view());
+    static_assert(idx.has_value(), "Serial port label is not found in devicetree");
+    return idx.value_or(0);
+}
+
+#if defined(CONFIG_PWM) && defined(CONFIG_PINCTRL)
+/// Timer channel connected to gpio pin and pin state which switches pin to the timer.
+struct GpioPwm {
+    struct pwm_dt_spec spec;
+    struct pinctrl_dev_config const* pinctrl;
+};
+
+/** Timer channel of gpio, described by `pwms` property of gpio node.
+ * Gpio itself must be borrowed by caller.
+ */
+std::optional<GpioPwm> gpio_pwm(uint8_t idx);
+#endif
+
 } // namespace dtb
 } // namespace mlplc
@@ -0,0 +1,28 @@
+#include <mlplc/error.hpp>
+
+#include <zephyr/logging/log.h>
+
+#include <magic_enum/magic_enum.hpp>
+
+namespace mlplc {
+
+LOG_MODULE_DECLARE(mlplc);
+
+std::string Error::message() const {
+    return std::string(this->where.file_name()) + ":" + std::to_string(this->where.line()) + " "
+        + this->where.function_name() + ": " + std::string(magic_enum::enum_name(this->type))
+        + " rc=" + std::to_string(this->rc);
+}
+
+void raise(Error const& error) {
+#if defined(CONFIG_CPP_EXCEPTIONS)
+    throw Exception(error.where.function_name(), error.type, " rc=", error.rc);
+#else
+    LOG_ERR("%s:%u: %s rc=%i", error.where.file_name(), static_cast<unsigned>(error.where.line()),
+        magic_enum::enum_name(error.type).data(), error.rc);
+    k_panic();
+    CODE_UNREACHABLE;
+#endif
+}
+
+} // namespace mlplc
@@ -0,0 +1,220 @@
+#include <mlplc/periph/frequency_input.hpp>
+#include "dtb.hpp"
+#include "macro.hpp"
+
+#include <zephyr/drivers/gpio.h>
+
+#include <new>
+#include <utility>
+
+namespace mlplc {
+namespace periph {
+
+FrequencyInput::FrequencyInput(
+    uint8_t port,
+    std::chrono::milliseconds window,
+    std::chrono::milliseconds timeout,
+    InputPull pull) :
+    FrequencyInput(dtb::borrow_gpio(port), port, window, timeout, pull)
+{
+    unwrap(this->_init());
+}
+
+FrequencyInput::FrequencyInput(
+    std::string_view label,
+    std::chrono::milliseconds window,
+    std::chrono::milliseconds timeout,
+    InputPull pull) :
+    FrequencyInput(dtb::find_gpio_idx_by_label(label), window, timeout, pull) {}
+
+FrequencyInput::FrequencyInput(
+    dtb::gpio_spec_t spec,
+    uint8_t port,
+    std::chrono::milliseconds window,
+    std::chrono::milliseconds timeout,
+    InputPull pull) :
+    _port(port),
+    _window(window),
+    _timeout(timeout),
+    _pull(pull),
+    _spec(std::move(spec))
+{}
+
+expected<std::unique_ptr<FrequencyInput>> FrequencyInput::new_unique(
+    uint8_t port,
+    std::chrono::milliseconds window,
+    std::chrono::milliseconds timeout,
+    InputPull pull)
+{
+    auto spec = dtb::try_borrow_gpio(port);
+    if (!spec) {
+        return std::unexpected(spec.error());
+    }
+    std::unique_ptr<FrequencyInput> input(
+        new (std::nothrow) FrequencyInput(std::move(*spec), port, window, timeout, pull));
+    TRY_ASSERT(input, ExceptionType::NoMemory);
+    TRY(input->_init());
+    return input;
+}
+
+expected<std::shared_ptr<FrequencyInput>> FrequencyInput::new_shared(
+    uint8_t port,
+    std::chrono::milliseconds window,
+    std::chrono::milliseconds timeout,
+    InputPull pull)
+{
+    auto input = FrequencyInput::new_unique(port, window, timeout, pull);
+    if (!input) {
+        return std::unexpected(input.error());
+    }
+    return std::shared_ptr<FrequencyInput>(std::move(*input));
+}
+
+expected<void> FrequencyInput::_init() {
+    if (this->_init_capture()) {
+        this->_source = MeasureSource::Capture;
+        return {};
+    }
+    TRY(this->_init_interrupt());
+    this->_source = MeasureSource::Interrupt;
+    return {};
+}
+
+expected<void> FrequencyInput::_init_capture() {
+#if defined(CONFIG_PWM_CAPTURE) && defined(CONFIG_PINCTRL)
+    auto const pwm = dtb::gpio_pwm(this->_port);
+    TRY_ASSERT(pwm, ExceptionType::NoDev);
+    TRY_CCALL(pwm_get_cycles_per_sec(pwm->spec.dev, pwm->spec.channel, &this->_cycles_per_sec));
+    this->_window_cycles = this->_cycles_per_sec * this->_window.count() / 1000;
+    TRY_CCALL(pwm_configure_capture(pwm->spec.dev, pwm->spec.channel,
+        PWM_CAPTURE_TYPE_BOTH | PWM_CAPTURE_MODE_CONTINUOUS | PWM_POLARITY_NORMAL,
+        FrequencyInput::_on_capture, this));
+    TRY_CCALL(pinctrl_apply_state(pwm->pinctrl, PINCTRL_STATE_DEFAULT));
+    TRY_CCALL(pwm_enable_capture(pwm->spec.dev, pwm->spec.channel));
+    this->_pwm = pwm;
+    return {};
+#else
+    return std::unexpected(Error{ExceptionType::NoDev});
+#endif
+}
+
+expected<void> FrequencyInput::_init_interrupt() {
+    gpio_flags_t flags = 0;
+    if (InputPull::Down == this->_pull) {
+        flags = GPIO_PULL_DOWN;
+    } else if (InputPull::Up == this->_pull) {
+        flags = GPIO_PULL_UP;
+    }
+    TRY_CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_INPUT | flags));
+    this->_cycles_per_sec = sys_clock_hw_cycles_per_sec();
+    this->_window_cycles = this->_cycles_per_sec * this->_window.count() / 1000;
+    this->_timeout_cycles = this->_cycles_per_sec * this->_timeout.count() / 1000;
+
+    this->_edge_callback.self = this;
+    gpio_init_callback(&this->_edge_callback.cb, FrequencyInput::_on_edge, BIT(this->_spec->pin));
+    TRY_CCALL(gpio_add_callback(this->_spec->port, &this->_edge_callback.cb));
+    int const rc = gpio_pin_interrupt_configure_dt(this->_spec.get(), GPIO_INT_EDGE_BOTH);
+    if (0 != rc) {
+        gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+        return std::unexpected(Error{exception_type_from_c_code(rc), rc});
+    }
+    return {};
+}
+
+FrequencyInput::~FrequencyInput() {
+    if (MeasureSource::Capture == this->_source) {
+#if defined(CONFIG_PWM_CAPTURE) && defined(CONFIG_PINCTRL)
+        pwm_disable_capture(this->_pwm->spec.dev, this->_pwm->spec.channel);
+#endif
+    } else {
+        gpio_pin_interrupt_configure_dt(this->_spec.get(), GPIO_INT_DISABLE);
+        gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+    }
+    gpio_pin_configure(this->_spec->port, this->_spec->pin, DEINIT_GPIO_MODE);
+}
+
+std::optional<Measurement> FrequencyInput::measurement() const {
+    if (0 == this->_measurement.version()) {
+        return std::nullopt;
+    }
+    Measurement const measurement = this->_measurement.read();
+    // Window is published at the end of period, so long silence means no signal.
+    if (sys::now() - measurement.time > this->_timeout) {
+        return std::nullopt;
+    }
+    return measurement;
+}
+
+float FrequencyInput::frequency() const {
+    auto const measurement = this->measurement();
+    return measurement ? measurement->frequency : 0.0f;
+}
+
+void FrequencyInput::_add_period(uint64_t period, uint64_t high) {
+    Window& acc = this->_acc;
+    acc.period_sum += period;
+    acc.high_sum += high;
+    acc.periods += 1;
+    if (acc.period_sum < this->_window_cycles) {
+        return;
+    }
+
+    uint64_t const period_ns = acc.period_sum * 1000000000ull / (this->_cycles_per_sec * acc.periods);
+    this->_measurement.write(Measurement{
+        .frequency = static_cast<float>(acc.periods) * static_cast<float>(this->_cycles_per_sec)
+            / static_cast<float>(acc.period_sum),
+        .period = std::chrono::nanoseconds(period_ns),
+        .duty = static_cast<float>(acc.high_sum) / static_cast<float>(acc.period_sum),
+        .periods = acc.periods,
+        .time = sys::now()});
+    acc = Window{};
+}
+
+void FrequencyInput::_on_edge(
+    [[maybe_unused]] struct device const* port,
+    struct gpio_callback* cb,
+    [[maybe_unused]] gpio_port_pins_t pins)
+{
+    FrequencyInput* const self = CONTAINER_OF(cb, EdgeCallback, cb)->self;
+    // Timestamp first, before any other ISR work.
+    uint64_t const t = sys::cycles();
+    if (0 == gpio_pin_get_dt(self->_spec.get())) {
+        self->_t_fall = t;
+        return;
+    }
+    if (self->_is_rise_seen && t - self->_t_rise > self->_timeout_cycles) {
+        // Rise after signal loss starts new measurement, period spanning the silence and partial window are dropped.
+        self->_acc = Window{};
+    } else if (self->_is_rise_seen && self->_t_fall > self->_t_rise) {
+        // Period is complete when fall between two rises is seen, glitch without it is skipped.
+        self->_add_period(t - self->_t_rise, self->_t_fall - self->_t_rise);
+    }
+    self->_t_rise = t;
+    self->_is_rise_seen = true;
+}
+
+#if defined(CONFIG_PWM_CAPTURE) && defined(CONFIG_PINCTRL)
+void FrequencyInput::_on_capture(
+    [[maybe_unused]] struct device const* dev,
+    [[maybe_unused]] uint32_t channel,
+    uint32_t period_cycles,
+    uint32_t pulse_cycles,
+    int status,
+    void* user_data)
+{
+    FrequencyInput* const self = static_cast<FrequencyInput*>(user_data);
+    auto const now = sys::now();
+    bool const is_gap = now - self->_t_capture > self->_timeout;
+    self->_t_capture = now;
+    // Overflowed or missed capture gives wrong period, and first capture after signal loss spans the silence.
+    // Such period is dropped together with partial window, as in _on_edge().
+    if (0 != status || 0 == period_cycles || is_gap) {
+        self->_acc = Window{};
+        return;
+    }
+    self->_add_period(period_cycles, pulse_cycles);
+}
+#endif
+
+} // namespace periph
+} // namespace mlplc
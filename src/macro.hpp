@@ -1,6 +1,7 @@
 #pragma once
 
 #include <mlplc/exception.hpp>
+#include <mlplc/error.hpp>
 
 #ifndef STR
 #define XSTR(x) #x
@@ -11,6 +12,8 @@
 
 #define CCALL_UNTIL(expr) do {int const _rc = expr; if (0 == _rc) {break;}} while (1)
 
+#if defined(CONFIG_CPP_EXCEPTIONS)
+
 #define CCALL(expr) do {int const _rc = expr; if (0 != _rc) { \
     throw Exception(std::string_view(MACRO_POSITION_SHORT ": " STR(expr) " failed: "), \
     exception_type_from_c_code(_rc), _rc);}} while (0)
@@ -18,3 +21,27 @@
 // ASSERT(bool expression, ExceptionType:: ...)
 #define ASSERT(expr, ...) do {if (!(expr)) { \
     throw Exception(std::string_view(MACRO_POSITION_SHORT  ": " STR(expr) " failed: "), ## __VA_ARGS__);}} while (0)
+
+#else
+
+// Without exceptions only error type and place are kept, see mlplc::raise().
+#define CCALL(expr) do {int const _rc = expr; if (0 != _rc) { \
+    ::mlplc::raise(::mlplc::Error{exception_type_from_c_code(_rc), _rc});}} while (0)
+
+#define ASSERT(expr, type, ...) do {if (!(expr)) { \
+    ::mlplc::raise(::mlplc::Error{type});}} while (0)
+
+#endif
+
+// Non-throwing variants for functions returning mlplc::expected.
+
+#define TRY_CCALL(expr) do {int const _rc = expr; if (0 != _rc) { \
+    return std::unexpected(::mlplc::Error{exception_type_from_c_code(_rc), _rc});}} while (0)
+
+// TRY_ASSERT(bool expression, ExceptionType:: ...)
+#define TRY_ASSERT(expr, type) do {if (!(expr)) { \
+    return std::unexpected(::mlplc::Error{type});}} while (0)
+
+// Propagate error of mlplc::expected<void> expression.
+#define TRY(expr) do {auto&& _result = expr; if (!_result) { \
+    return std::unexpected(_result.error());}} while (0)
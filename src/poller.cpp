@@ -0,0 +1,49 @@
+#include <mlplc/sys/poller.hpp>
+
+namespace mlplc {
+namespace sys {
+
+Poller::~Poller() {
+    for (std::size_t i = 0; i < this->_size; i++) {
+        this->_entries[i].unsubscribe(this->_entries[i].source, &this->_entries[i]);
+    }
+}
+
+poll_mask_t Poller::wait(timeout_t timeout) {
+    poll_mask_t const all = this->_size < 32 ? BIT(this->_size) - 1 : UINT32_MAX;
+    Deadline const deadline(timeout);
+    poll_mask_t fired = 0;
+    if (0 == this->_polled) {
+        fired = this->_events.wait(all, deadline);
+    } else {
+        while (1) {
+            for (std::size_t i = 0; i < this->_size; i++) {
+                if (this->_entries[i].poll) {
+                    this->_entries[i].poll(this->_entries[i].source);
+                }
+            }
+            timeout_t slice = POLL_INTERVAL;
+            auto const remain = deadline.remain();
+            if (remain && *remain < *slice) {
+                slice = remain;
+            }
+            fired = this->_events.wait(all, Deadline(slice));
+            if (0 != fired || deadline.is_expired()) {
+                break;
+            }
+        }
+    }
+    this->_events.clear(fired);
+    return fired;
+}
+
+bool Poller::_on_event(Listener* listener, uint32_t value) {
+    auto* const entry = static_cast<Entry*>(listener);
+    if (!entry->value || *entry->value == value) {
+        entry->poller->_events.post(entry->bit);
+    }
+    return true;
+}
+
+} // namespace sys
+} // namespace mlplc
@@ -0,0 +1,55 @@
+#include <mlplc/periph/process_image.hpp>
+
+#include <mutex>
+
+namespace mlplc {
+namespace periph {
+
+ProcessImage::ProcessImage(std::span<uint8_t const> inputs, std::span<uint8_t const> outputs,
+    InputPull pull, OutputType type) :
+    _input_group(inputs, pull),
+    _output_group(outputs, type)
+{
+    this->read_inputs();
+}
+
+ProcessImage::ProcessImage(std::initializer_list<uint8_t> inputs, std::initializer_list<uint8_t> outputs,
+    InputPull pull, OutputType type) :
+    ProcessImage(std::span<uint8_t const>(inputs.begin(), inputs.size()),
+        std::span<uint8_t const>(outputs.begin(), outputs.size()), pull, type) {}
+
+ProcessImage::~ProcessImage() {
+    this->stop();
+}
+
+void ProcessImage::read_inputs() {
+    Inputs const prev = this->_inputs.read();
+    this->_inputs.write(Inputs {.levels = this->_input_group.levels(), .cycle = prev.cycle + 1});
+}
+
+void ProcessImage::write_outputs() {
+    this->_output_group.set_levels(this->_outputs.load(std::memory_order_acquire));
+}
+
+void ProcessImage::set_outputs(group_mask_t mask, group_mask_t levels) {
+    group_mask_t current = this->_outputs.load(std::memory_order_relaxed);
+    while (!this->_outputs.compare_exchange_weak(current, (current & ~mask) | (levels & mask),
+        std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+void ProcessImage::start(std::chrono::microseconds period, uint8_t priority) {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    if (!this->_task) {
+        this->_task = std::make_unique<sys::CyclicTask>("process_image", period, nullptr, THREAD_STACK_SIZE,
+            priority, [this]() { this->read_inputs(); }, [this]() { this->write_outputs(); });
+        this->_task->start();
+    }
+}
+
+void ProcessImage::stop() {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    this->_task = nullptr;
+}
+
+} // namespace periph
+} // namespace mlplc
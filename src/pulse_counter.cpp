@@ -0,0 +1,211 @@
+#include <mlplc/periph/pulse_counter.hpp>
+#include "dtb.hpp"
+#include "debouncer.hpp"
+#include "macro.hpp"
+
+#include <zephyr/drivers/gpio.h>
+
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mlplc {
+namespace periph {
+
+namespace {
+
+gpio_flags_t pull_flags(InputPull pull) {
+    if (InputPull::Down == pull) {
+        return GPIO_PULL_DOWN;
+    } else if (InputPull::Up == pull) {
+        return GPIO_PULL_UP;
+    }
+    return 0;
+}
+
+} // namespace
+
+PulseCounter::PulseCounter(
+    uint8_t port,
+    CountMode mode,
+    CountEdge edge,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration) :
+    PulseCounter(dtb::borrow_gpio(port), port, mode, edge, pull, debounce_duration)
+{
+    unwrap(this->_init());
+}
+
+PulseCounter::PulseCounter(
+    std::string_view label,
+    CountMode mode,
+    CountEdge edge,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration) :
+    PulseCounter(dtb::find_gpio_idx_by_label(label), mode, edge, pull, debounce_duration) {}
+
+PulseCounter::PulseCounter(
+    dtb::gpio_spec_t spec,
+    uint8_t port,
+    CountMode mode,
+    CountEdge edge,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration) :
+    _port(port),
+    _mode(mode),
+    _edge(edge),
+    _pull(pull),
+    _debounce_duration(debounce_duration),
+    _spec(std::move(spec))
+{}
+
+expected<std::unique_ptr<PulseCounter>> PulseCounter::new_unique(
+    uint8_t port,
+    CountMode mode,
+    CountEdge edge,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration)
+{
+    auto spec = dtb::try_borrow_gpio(port);
+    if (!spec) {
+        return std::unexpected(spec.error());
+    }
+    std::unique_ptr<PulseCounter> counter(
+        new (std::nothrow) PulseCounter(std::move(*spec), port, mode, edge, pull, debounce_duration));
+    TRY_ASSERT(counter, ExceptionType::NoMemory);
+    TRY(counter->_init());
+    return counter;
+}
+
+expected<std::shared_ptr<PulseCounter>> PulseCounter::new_shared(
+    uint8_t port,
+    CountMode mode,
+    CountEdge edge,
+    InputPull pull,
+    std::chrono::milliseconds debounce_duration)
+{
+    auto counter = PulseCounter::new_unique(port, mode, edge, pull, debounce_duration);
+    if (!counter) {
+        return std::unexpected(counter.error());
+    }
+    return std::shared_ptr<PulseCounter>(std::move(*counter));
+}
+
+expected<void> PulseCounter::_init() {
+    this->_rate_time = sys::now();
+
+    if (CountMode::Interrupt == this->_mode) {
+        return this->_init_interrupt();
+    }
+    if (CountMode::Polled == this->_mode) {
+        return this->_init_polled();
+    }
+
+    if (this->_init_interrupt()) {
+        this->_mode = CountMode::Interrupt;
+    } else {
+        TRY(this->_init_polled());
+        this->_mode = CountMode::Polled;
+    }
+    return {};
+}
+
+expected<void> PulseCounter::_init_interrupt() {
+    TRY_CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_INPUT | pull_flags(this->_pull)));
+
+    // Logical edges, as levels of polled mode - active low pin counts the same edges in both modes.
+    gpio_flags_t irq_flags = GPIO_INT_EDGE_BOTH;
+    if (CountEdge::Rising == this->_edge) {
+        irq_flags = GPIO_INT_EDGE_TO_ACTIVE;
+    } else if (CountEdge::Falling == this->_edge) {
+        irq_flags = GPIO_INT_EDGE_TO_INACTIVE;
+    }
+    this->_edge_callback.self = this;
+    gpio_init_callback(&this->_edge_callback.cb, PulseCounter::_on_edge, BIT(this->_spec->pin));
+    TRY_CCALL(gpio_add_callback(this->_spec->port, &this->_edge_callback.cb));
+    int const rc = gpio_pin_interrupt_configure_dt(this->_spec.get(), irq_flags);
+    if (0 != rc) {
+        gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+        return std::unexpected(Error{exception_type_from_c_code(rc), rc});
+    }
+    return {};
+}
+
+expected<void> PulseCounter::_init_polled() {
+    TRY_CCALL(gpio_pin_configure(this->_spec->port, this->_spec->pin, GPIO_INPUT | pull_flags(this->_pull)));
+    this->_debounce_listener.on_event = PulseCounter::_on_debounced;
+    this->_debounce_listener.self = this;
+    return _private::g_debouncer.add(this->_port, *this->_spec, this->_debounce_duration,
+        nullptr, 0, &this->_debounce_listener);
+}
+
+PulseCounter::~PulseCounter() {
+    if (CountMode::Interrupt == this->_mode) {
+        gpio_pin_interrupt_configure_dt(this->_spec.get(), GPIO_INT_DISABLE);
+        gpio_remove_callback(this->_spec->port, &this->_edge_callback.cb);
+    } else if (CountMode::Polled == this->_mode) {
+        _private::g_debouncer.remove(this->_port);
+    }
+    gpio_pin_configure(this->_spec->port, this->_spec->pin, DEINIT_GPIO_MODE);
+}
+
+uint32_t PulseCounter::count() const {
+    // Base first - total read later is never behind it, whatever reset() does in between.
+    uint32_t const base = this->_base.load(std::memory_order_acquire);
+    return this->_total() - base;
+}
+
+uint32_t PulseCounter::reset() {
+    // Pulses after total is read belong to the new count. Rebase succeeds only if no other reset()
+    // moved base meanwhile, so concurrent resets split pulses between them without overlap.
+    uint32_t base = this->_base.load(std::memory_order_acquire);
+    while (1) {
+        uint32_t const total = this->_total();
+        if (this->_base.compare_exchange_weak(base, total, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return total - base;
+        }
+    }
+}
+
+float PulseCounter::rate() {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    uint32_t const total = this->_total();
+    auto const now = sys::now();
+    auto const elapsed = now - this->_rate_time;
+    float const result = elapsed.count() > 0
+        ? static_cast<float>(total - this->_rate_pulses) * 1e9f / static_cast<float>(elapsed.count())
+        : 0.0f;
+    this->_rate_pulses = total;
+    this->_rate_time = now;
+    return result;
+}
+
+uint32_t PulseCounter::_total() const {
+    return this->_pulses.load(std::memory_order_acquire);
+}
+
+bool PulseCounter::_is_counted(Level level) const {
+    return CountEdge::Both == this->_edge
+        || (CountEdge::Rising == this->_edge && Level::High == level)
+        || (CountEdge::Falling == this->_edge && Level::Low == level);
+}
+
+void PulseCounter::_on_edge(
+    [[maybe_unused]] struct device const* port,
+    struct gpio_callback* cb,
+    [[maybe_unused]] gpio_port_pins_t pins)
+{
+    // Edge type is filtered by interrupt configuration.
+    CONTAINER_OF(cb, EdgeCallback, cb)->self->_pulses.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool PulseCounter::_on_debounced(sys::Listener* listener, uint32_t value) {
+    PulseCounter* const self = static_cast<DebounceListener*>(listener)->self;
+    if (self->_is_counted(level_from_num(value))) {
+        self->_pulses.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+} // namespace periph
+} // namespace mlplc
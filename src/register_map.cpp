@@ -0,0 +1,278 @@
+#include <mlplc/modbus/register_map.hpp>
+#include "macro.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace mlplc {
+namespace modbus {
+
+namespace {
+
+constexpr std::size_t div_ceil(std::size_t a, std::size_t b) {
+    return (a + b - 1) / b;
+}
+
+} // namespace
+
+RegisterMap::RangeLock::RangeLock(TableData const& data, std::size_t offset, std::size_t count) :
+    _locks(data.locks.get()),
+    _first(offset / data.per_lock),
+    _last((offset + count - 1) / data.per_lock)
+{
+    for (std::size_t i = this->_first; i <= this->_last; i++) {
+        this->_locks[i].lock();
+    }
+}
+
+RegisterMap::RangeLock::~RangeLock() {
+    for (std::size_t i = this->_last + 1; i-- > this->_first;) {
+        this->_locks[i].unlock();
+    }
+}
+
+RegisterMap::RegisterMap(RegisterMapLayout const& layout) {
+    std::array<TableRange, TABLE_COUNT> const ranges = {
+        layout.coils, layout.discrete_inputs, layout.input_registers, layout.holding_registers};
+    for (std::size_t t = 0; t < TABLE_COUNT; t++) {
+        auto& data = this->_tables[t];
+        data.range = ranges[t];
+        if (0 == data.range.count) {
+            continue;
+        }
+        ASSERT(data.range.start + data.range.count <= 0x10000, ExceptionType::InvalidArgument,
+            "Table exceeds address space: ", static_cast<int>(t));
+        bool const is_bits = is_bit_table(static_cast<Table>(t));
+        std::size_t const words = is_bits ? div_ceil(data.range.count, 16) : data.range.count;
+        data.per_lock = is_bits ? BITS_PER_LOCK : REGISTERS_PER_LOCK;
+        data.words.reset(new (std::nothrow) uint16_t[words]());
+        data.locks.reset(new (std::nothrow) sys::SpinLock[div_ceil(data.range.count, data.per_lock)]);
+        ASSERT(data.words && data.locks, ExceptionType::NoMemory, "Register map table: ", static_cast<int>(t));
+        if (is_client_writable(static_cast<Table>(t))) {
+            data.dirty_words = div_ceil(data.range.count, 32);
+            data.dirty.reset(new (std::nothrow) std::atomic<uint32_t>[data.dirty_words]());
+            ASSERT(data.dirty, ExceptionType::NoMemory, "Register map dirty bitmap: ", static_cast<int>(t));
+        }
+    }
+}
+
+std::optional<std::size_t> RegisterMap::_offset(Table table, uint16_t addr, std::size_t count) const {
+    TableRange const range = this->range(table);
+    if (0 == count || addr < range.start || addr + count > static_cast<std::size_t>(range.start) + range.count) {
+        return std::nullopt;
+    }
+    return addr - range.start;
+}
+
+bool RegisterMap::read(Table table, uint16_t addr, std::span<uint16_t> out) const {
+    auto const offset = this->_offset(table, addr, out.size());
+    if (!offset || is_bit_table(table)) {
+        return false;
+    }
+    auto const& data = this->_tables[static_cast<std::size_t>(table)];
+    RangeLock const lock(data, *offset, out.size());
+    std::memcpy(out.data(), data.words.get() + *offset, out.size_bytes());
+    return true;
+}
+
+bool RegisterMap::write(Table table, uint16_t addr, std::span<uint16_t const> values) {
+    auto const offset = this->_offset(table, addr, values.size());
+    if (!offset || is_bit_table(table)) {
+        return false;
+    }
+    this->_write_registers(this->_tables[static_cast<std::size_t>(table)], *offset, values, false);
+    return true;
+}
+
+bool RegisterMap::client_write(Table table, uint16_t addr, std::span<uint16_t const> values) {
+    auto const offset = this->_offset(table, addr, values.size());
+    if (!offset || Table::HoldingRegisters != table) {
+        return false;
+    }
+    this->_write_registers(this->_tables[static_cast<std::size_t>(table)], *offset, values, true);
+    return true;
+}
+
+bool RegisterMap::read_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t> packed) const {
+    auto const offset = this->_offset(table, addr, count);
+    if (!offset || !is_bit_table(table) || packed.size() < div_ceil(count, 8)) {
+        return false;
+    }
+    auto const& data = this->_tables[static_cast<std::size_t>(table)];
+    std::fill_n(packed.begin(), div_ceil(count, 8), 0);
+    RangeLock const lock(data, *offset, count);
+    for (std::size_t i = 0; i < count; i++) {
+        std::size_t const e = *offset + i;
+        if (data.words[e / 16] & (1u << (e % 16))) {
+            packed[i / 8] |= 1u << (i % 8);
+        }
+    }
+    return true;
+}
+
+bool RegisterMap::write_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t const> packed) {
+    auto const offset = this->_offset(table, addr, count);
+    if (!offset || !is_bit_table(table) || packed.size() < div_ceil(count, 8)) {
+        return false;
+    }
+    this->_write_bits(this->_tables[static_cast<std::size_t>(table)], *offset, count, packed, false);
+    return true;
+}
+
+bool RegisterMap::client_write_bits(Table table, uint16_t addr, uint16_t count, std::span<uint8_t const> packed) {
+    auto const offset = this->_offset(table, addr, count);
+    if (!offset || Table::Coils != table || packed.size() < div_ceil(count, 8)) {
+        return false;
+    }
+    this->_write_bits(this->_tables[static_cast<std::size_t>(table)], *offset, count, packed, true);
+    return true;
+}
+
+uint16_t RegisterMap::reg(Table table, uint16_t addr) const {
+    uint16_t value = 0;
+    ASSERT(this->read(table, addr, std::span<uint16_t>(&value, 1)), ExceptionType::NoDev,
+        "Register is not in map: ", addr);
+    return value;
+}
+
+void RegisterMap::set_reg(Table table, uint16_t addr, uint16_t value) {
+    ASSERT(this->write(table, addr, std::span<uint16_t const>(&value, 1)), ExceptionType::NoDev,
+        "Register is not in map: ", addr);
+}
+
+bool RegisterMap::bit(Table table, uint16_t addr) const {
+    uint8_t packed = 0;
+    ASSERT(this->read_bits(table, addr, 1, std::span<uint8_t>(&packed, 1)), ExceptionType::NoDev,
+        "Bit is not in map: ", addr);
+    return packed;
+}
+
+void RegisterMap::set_bit(Table table, uint16_t addr, bool value) {
+    uint8_t const packed = value;
+    ASSERT(this->write_bits(table, addr, 1, std::span<uint8_t const>(&packed, 1)), ExceptionType::NoDev,
+        "Bit is not in map: ", addr);
+}
+
+bool RegisterMap::is_changed(Table table, uint16_t addr, uint16_t count) const {
+    auto const offset = this->_offset(table, addr, count);
+    auto const& data = this->_tables[static_cast<std::size_t>(table)];
+    if (!offset || !data.dirty) {
+        return false;
+    }
+    for (std::size_t e = *offset; e < *offset + count; e++) {
+        if (data.dirty[e / 32].load(std::memory_order_relaxed) & (uint32_t(1) << (e % 32))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void RegisterMap::_write_registers(TableData& data, std::size_t offset, std::span<uint16_t const> values,
+    bool is_client)
+{
+    {
+        RangeLock const lock(data, offset, values.size());
+        std::memcpy(data.words.get() + offset, values.data(), values.size_bytes());
+    }
+    if (is_client) {
+        this->_mark_changed(data, offset, values.size());
+    }
+}
+
+void RegisterMap::_write_bits(TableData& data, std::size_t offset, uint16_t count, std::span<uint8_t const> packed,
+    bool is_client)
+{
+    {
+        RangeLock const lock(data, offset, count);
+        for (std::size_t i = 0; i < count; i++) {
+            std::size_t const e = offset + i;
+            uint16_t const mask = 1u << (e % 16);
+            if (packed[i / 8] & (1u << (i % 8))) {
+                data.words[e / 16] |= mask;
+            } else {
+                data.words[e / 16] &= ~mask;
+            }
+        }
+    }
+    if (is_client) {
+        this->_mark_changed(data, offset, count);
+    }
+}
+
+void RegisterMap::_mark_changed(TableData& data, std::size_t offset, std::size_t count) {
+    // Marks are set after values, so application sees written value once it sees the mark.
+    std::size_t e = offset;
+    std::size_t const end = offset + count;
+    while (e < end) {
+        std::size_t const bit = e % 32;
+        std::size_t const n = std::min<std::size_t>(32 - bit, end - e);
+        uint32_t const mask = (n == 32 ? ~uint32_t(0) : ((uint32_t(1) << n) - 1)) << bit;
+        data.dirty[e / 32].fetch_or(mask, std::memory_order_release);
+        e += n;
+    }
+    this->_client_writes.fetch_add(1, std::memory_order_release);
+}
+
+#if defined(CONFIG_MODBUS)
+namespace {
+
+RegisterMap* served_map = nullptr;
+
+int coil_rd(uint16_t addr, bool* state) {
+    uint8_t packed = 0;
+    if (!served_map->read_bits(Table::Coils, addr, 1, std::span<uint8_t>(&packed, 1))) {
+        return -ENOTSUP;
+    }
+    *state = packed;
+    return 0;
+}
+
+int coil_wr(uint16_t addr, bool state) {
+    uint8_t const packed = state;
+    return served_map->client_write_bits(Table::Coils, addr, 1, std::span<uint8_t const>(&packed, 1)) ? 0 : -ENOTSUP;
+}
+
+int discrete_input_rd(uint16_t addr, bool* state) {
+    uint8_t packed = 0;
+    if (!served_map->read_bits(Table::DiscreteInputs, addr, 1, std::span<uint8_t>(&packed, 1))) {
+        return -ENOTSUP;
+    }
+    *state = packed;
+    return 0;
+}
+
+int input_reg_rd(uint16_t addr, uint16_t* reg) {
+    return served_map->read(Table::InputRegisters, addr, std::span<uint16_t>(reg, 1)) ? 0 : -ENOTSUP;
+}
+
+int holding_reg_rd(uint16_t addr, uint16_t* reg) {
+    return served_map->read(Table::HoldingRegisters, addr, std::span<uint16_t>(reg, 1)) ? 0 : -ENOTSUP;
+}
+
+int holding_reg_wr(uint16_t addr, uint16_t reg) {
+    return served_map->client_write(Table::HoldingRegisters, addr, std::span<uint16_t const>(&reg, 1)) ? 0 : -ENOTSUP;
+}
+
+struct modbus_user_callbacks callbacks = {
+    .coil_rd = coil_rd,
+    .coil_wr = coil_wr,
+    .discrete_input_rd = discrete_input_rd,
+    .input_reg_rd = input_reg_rd,
+    .input_reg_rd_fp = nullptr,
+    .holding_reg_rd = holding_reg_rd,
+    .holding_reg_wr = holding_reg_wr,
+    .holding_reg_rd_fp = nullptr,
+    .holding_reg_wr_fp = nullptr,
+};
+
+} // namespace
+
+struct modbus_user_callbacks* server_callbacks(RegisterMap& map) {
+    served_map = &map;
+    return &callbacks;
+}
+#endif
+
+} // namespace modbus
+} // namespace mlplc
@@ -0,0 +1,313 @@
+#include <mlplc/modbus/rtu_poller.hpp>
+#include "macro.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <tuple>
+
+#if defined(CONFIG_UART_ASYNC_API)
+
+namespace mlplc {
+namespace modbus {
+
+namespace {
+
+/// Largest RTU frame.
+constexpr std::size_t FRAME_SIZE = 256;
+
+constexpr std::size_t div_ceil(std::size_t a, std::size_t b) {
+    return (a + b - 1) / b;
+}
+
+constexpr uint16_t read_limit(Table table) {
+    return is_bit_table(table) ? MAX_READ_BITS : MAX_READ_REGISTERS;
+}
+
+constexpr uint8_t read_function(Table table) {
+    switch (table) {
+    case Table::Coils:
+        return 0x01;
+    case Table::DiscreteInputs:
+        return 0x02;
+    case Table::HoldingRegisters:
+        return 0x03;
+    case Table::InputRegisters:
+        return 0x04;
+    }
+    return 0;
+}
+
+} // namespace
+
+RtuPoller::RtuPoller(periph::Serial& serial, RtuPollerConfig const& config) :
+    _serial(serial),
+    _config(config)
+{
+    ASSERT(8 == serial.config().data_bits, ExceptionType::InvalidArgument, "Modbus RTU requires 8 data bits");
+}
+
+RtuPoller::~RtuPoller() {
+    this->stop();
+}
+
+std::size_t RtuPoller::add(PollItem const& item) {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    ASSERT(!this->_thread, ExceptionType::DeviceAlreadyInUse, "Poller is running");
+    ASSERT(this->_size < POLL_MAX_ITEMS, ExceptionType::NoMemory, "Too many poll items");
+    ASSERT(item.count > 0 && item.count <= read_limit(item.table) && item.start + item.count <= 0x10000
+        && item.period.count() > 0, ExceptionType::InvalidArgument, "Bad poll item: ", item.start);
+
+    std::size_t slot = 0;
+    while (slot < this->_slave_count && this->_slaves[slot].address != item.slave) {
+        slot += 1;
+    }
+    if (slot == this->_slave_count) {
+        ASSERT(this->_slave_count < POLL_MAX_SLAVES, ExceptionType::NoMemory, "Too many slaves: ", item.slave);
+        this->_slaves[slot].address = item.slave;
+        this->_slave_count += 1;
+    }
+
+    auto& added = this->_items[this->_size];
+    added.values.reset(new (std::nothrow) uint16_t[2 * item.count]());
+    ASSERT(added.values, ExceptionType::NoMemory, "Poll item values");
+    added.poll = item;
+    added.slave_slot = slot;
+    return this->_size++;
+}
+
+void RtuPoller::start(uint8_t priority) {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    if (this->_thread) {
+        return;
+    }
+    auto const now = sys::now();
+    for (std::size_t i = 0; i < this->_size; i++) {
+        this->_items[i].next_due = now;
+    }
+    this->_wake.clear(WAKE);
+    this->_is_running.store(true, std::memory_order_release);
+    this->_thread = std::make_unique<sys::Thread<>>("rtu_poller", [this]() { this->_run(); },
+        THREAD_STACK_SIZE, priority);
+    this->_thread->start();
+}
+
+void RtuPoller::stop() {
+    std::lock_guard<sys::Mutex> lock(this->_mutex);
+    if (!this->_thread) {
+        return;
+    }
+    this->_is_running.store(false, std::memory_order_release);
+    this->_wake.post(WAKE);
+    this->_thread->join();
+    this->_thread = nullptr;
+}
+
+PollResult RtuPoller::read(std::size_t item, std::span<uint16_t> out) const {
+    ASSERT(item < this->_size, ExceptionType::NoDev, "Unknown poll item: ", item);
+    auto const& polled = this->_items[item];
+    std::size_t const count = polled.poll.count;
+    std::size_t const n = std::min(out.size(), count);
+    while (1) {
+        uint32_t const seq = polled.seq.load(std::memory_order_acquire);
+        std::copy_n(polled.values.get() + (seq & 1) * count, n, out.begin());
+        PollResult const result = polled.results[seq & 1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (polled.seq.load(std::memory_order_relaxed) == seq) {
+            return result;
+        }
+    }
+}
+
+std::optional<SlaveStats> RtuPoller::slave_stats(uint8_t slave) const {
+    for (std::size_t i = 0; i < this->_slave_count; i++) {
+        if (this->_slaves[i].address == slave) {
+            return this->_slaves[i].stats.read();
+        }
+    }
+    return std::nullopt;
+}
+
+void RtuPoller::_run() {
+    while (this->_is_running.load(std::memory_order_acquire)) {
+        auto const now = sys::now();
+        std::size_t const requests = this->_plan(now);
+        // Serial reports frame end after t3.5 idle, so the next request is sent right away -
+        // round takes only frame times and slave turnarounds.
+        for (std::size_t i = 0; i < requests && this->_is_running.load(std::memory_order_acquire); i++) {
+            this->_transact(this->_requests[i]);
+        }
+
+        // Items keep their phase, late items skip missed periods instead of bursting.
+        auto const done = sys::now();
+        auto next = std::chrono::nanoseconds::max();
+        for (std::size_t i = 0; i < this->_size; i++) {
+            auto& item = this->_items[i];
+            if (item.next_due <= now) {
+                item.next_due += item.poll.period;
+                if (item.next_due <= done) {
+                    item.next_due = done + item.poll.period;
+                }
+            }
+            next = std::min(next, item.next_due);
+        }
+        sys::timeout_t timeout = sys::FOREVER;
+        if (this->_size > 0) {
+            timeout = std::max(std::chrono::ceil<std::chrono::microseconds>(next - sys::now()),
+                std::chrono::microseconds(0));
+        }
+        this->_wake.wait(WAKE, sys::Deadline(timeout));
+    }
+}
+
+std::size_t RtuPoller::_plan(std::chrono::nanoseconds now) {
+    std::size_t due = 0;
+    for (std::size_t i = 0; i < this->_size; i++) {
+        if (this->_items[i].next_due <= now) {
+            this->_order[due++] = i;
+        }
+    }
+    std::sort(this->_order.begin(), this->_order.begin() + due, [this](uint8_t a, uint8_t b) {
+        auto const& x = this->_items[a].poll;
+        auto const& y = this->_items[b].poll;
+        return std::tie(x.slave, x.table, x.start) < std::tie(y.slave, y.table, y.start);
+    });
+
+    // Sorted ranges of one slave and table are merged while the gap and the merged size are within limits.
+    std::size_t count = 0;
+    for (std::size_t k = 0; k < due; k++) {
+        auto const& poll = this->_items[this->_order[k]].poll;
+        if (count > 0) {
+            auto& request = this->_requests[count - 1];
+            auto const& head = this->_items[this->_order[request.first]].poll;
+            std::size_t const end = request.start + request.count;
+            std::size_t const merged_end = std::max<std::size_t>(end, poll.start + poll.count);
+            if (head.slave == poll.slave && head.table == poll.table && poll.start <= end + this->_config.max_gap
+                && merged_end - request.start <= read_limit(poll.table))
+            {
+                request.count = merged_end - request.start;
+                request.last = k + 1;
+                continue;
+            }
+        }
+        this->_requests[count++] = Request{
+            .first = static_cast<uint8_t>(k),
+            .last = static_cast<uint8_t>(k + 1),
+            .start = poll.start,
+            .count = poll.count};
+    }
+
+    // Frames of the whole round are built before the bus is taken.
+    for (std::size_t i = 0; i < count; i++) {
+        auto& request = this->_requests[i];
+        auto const& head = this->_items[this->_order[request.first]].poll;
+        auto& frame = request.frame;
+        frame[0] = head.slave;
+        frame[1] = read_function(head.table);
+        frame[2] = request.start >> 8;
+        frame[3] = request.start & 0xff;
+        frame[4] = request.count >> 8;
+        frame[5] = request.count & 0xff;
+        uint16_t const crc = crc16(std::span<uint8_t const>(frame.data(), 6));
+        frame[6] = crc & 0xff;
+        frame[7] = crc >> 8;
+    }
+    return count;
+}
+
+void RtuPoller::_transact(Request const& request) {
+    auto const& head = this->_items[this->_order[request.first]];
+    auto const timeout = std::chrono::duration_cast<std::chrono::microseconds>(this->_config.response_timeout);
+    std::size_t const data_size = is_bit_table(head.poll.table) ? div_ceil(request.count, 8) : 2 * request.count;
+
+    // Late response to previous request or noise must not be taken as response.
+    this->_serial.clear();
+    PollStatus status = PollStatus::Timeout;
+    uint8_t exception = 0;
+    std::array<uint8_t, FRAME_SIZE> rx;
+    auto sent = sys::now();
+    if (this->_serial.write_all<uint8_t>(request.frame, timeout) && this->_serial.flush(timeout)) {
+        sent = sys::now();
+        auto const frame = this->_serial.wait_frame<uint8_t>(timeout);
+        if (frame) {
+            std::size_t const size = frame->size();
+            frame->copy_to(rx);
+            this->_serial.consume(size);
+            // CRC of frame with its CRC is 0.
+            if (size < 5 || size > rx.size() || 0 != crc16(std::span<uint8_t const>(rx.data(), size))
+                || rx[0] != head.poll.slave)
+            {
+                status = PollStatus::BadResponse;
+            } else if (rx[1] == (request.frame[1] | 0x80) && 5 == size) {
+                status = PollStatus::Exception;
+                exception = rx[2];
+            } else if (rx[1] == request.frame[1] && 5 + data_size == size && rx[2] == data_size) {
+                status = PollStatus::Ok;
+            } else {
+                status = PollStatus::BadResponse;
+            }
+        }
+    }
+    auto const now = sys::now();
+
+    for (std::size_t k = request.first; k < request.last; k++) {
+        auto& item = this->_items[this->_order[k]];
+        this->_publish(item, status, exception, rx.data() + 3, item.poll.start - request.start, now);
+    }
+    this->_account(this->_slaves[head.slave_slot], status, now - sent);
+}
+
+void RtuPoller::_publish(Item& item, PollStatus status, uint8_t exception, uint8_t const* data, std::size_t offset,
+    std::chrono::nanoseconds now)
+{
+    std::size_t const count = item.poll.count;
+    uint32_t const seq = item.seq.load(std::memory_order_relaxed);
+    uint16_t* const values = item.values.get() + ((seq + 1) & 1) * count;
+    PollResult result = item.results[seq & 1];
+    if (PollStatus::Ok == status) {
+        if (is_bit_table(item.poll.table)) {
+            for (std::size_t i = 0; i < count; i++) {
+                std::size_t const b = offset + i;
+                values[i] = (data[b / 8] >> (b % 8)) & 1;
+            }
+        } else {
+            for (std::size_t i = 0; i < count; i++) {
+                std::size_t const b = 2 * (offset + i);
+                values[i] = (data[b] << 8) | data[b + 1];
+            }
+        }
+        result.updated = now;
+    } else {
+        std::copy_n(item.values.get() + (seq & 1) * count, count, values);
+    }
+    result.status = status;
+    result.exception = exception;
+    result.version = seq + 1;
+    item.results[(seq + 1) & 1] = result;
+    item.seq.store(seq + 1, std::memory_order_release);
+}
+
+void RtuPoller::_account(Slave& slave, PollStatus status, std::chrono::nanoseconds latency) {
+    auto& acc = slave.acc;
+    acc.requests += 1;
+    if (PollStatus::Timeout == status) {
+        acc.timeouts += 1;
+    } else {
+        acc.responses += 1;
+        if (PollStatus::Ok != status) {
+            acc.errors += 1;
+        }
+        auto const us = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+        acc.latency_last = us;
+        acc.latency_min = 1 == acc.responses ? us : std::min(acc.latency_min, us);
+        acc.latency_max = std::max(acc.latency_max, us);
+        slave.latency_sum_us += us.count();
+        acc.latency_avg = std::chrono::microseconds(slave.latency_sum_us / acc.responses);
+    }
+    slave.stats.write(acc);
+}
+
+} // namespace modbus
+} // namespace mlplc
+
+#endif // CONFIG_UART_ASYNC_API
@@ -0,0 +1,440 @@
+#include <mlplc/periph/serial.hpp>
+#include "dtb.hpp"
+#include "macro.hpp"
+
+#if defined(CONFIG_UART_ASYNC_API)
+
+#include <zephyr/drivers/uart.h>
+
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace mlplc {
+namespace periph {
+
+namespace {
+
+constexpr std::chrono::microseconds MODBUS_MIN_IDLE = 1750us;
+constexpr std::chrono::milliseconds CLOSE_TIMEOUT = 100ms;
+
+// 9-bit words go through wide data API, buffers are the same byte rings.
+
+int rx_enable(struct device const* dev, std::span<uint8_t> region, std::size_t word_size, int32_t timeout_us) {
+#if defined(CONFIG_UART_WIDE_DATA)
+    if (sizeof(uint16_t) == word_size) {
+        return uart_rx_enable_u16(dev, reinterpret_cast<uint16_t*>(region.data()), region.size() / word_size,
+            timeout_us);
+    }
+#endif
+    return uart_rx_enable(dev, region.data(), region.size(), timeout_us);
+}
+
+int rx_buf_rsp(struct device const* dev, std::span<uint8_t> region, std::size_t word_size) {
+#if defined(CONFIG_UART_WIDE_DATA)
+    if (sizeof(uint16_t) == word_size) {
+        return uart_rx_buf_rsp_u16(dev, reinterpret_cast<uint16_t*>(region.data()), region.size() / word_size);
+    }
+#endif
+    return uart_rx_buf_rsp(dev, region.data(), region.size());
+}
+
+int tx(struct device const* dev, uint8_t const* data, std::size_t words, std::size_t word_size) {
+#if defined(CONFIG_UART_WIDE_DATA)
+    if (sizeof(uint16_t) == word_size) {
+        return uart_tx_u16(dev, reinterpret_cast<uint16_t const*>(data), words, SYS_FOREVER_US);
+    }
+#endif
+    return uart_tx(dev, data, words, SYS_FOREVER_US);
+}
+
+} // namespace
+
+Serial::Serial(uint8_t idx, SerialConfig const& config) :
+    Serial(dtb::borrow_serial(idx), config)
+{
+    unwrap(this->_init());
+}
+
+Serial::Serial(std::string_view label, SerialConfig const& config) :
+    Serial(dtb::find_serial_idx_by_label(label), config) {}
+
+Serial::Serial(dtb::serial_spec_t spec, SerialConfig const& config) :
+    _config(config),
+    _spec(std::move(spec))
+{}
+
+expected<std::unique_ptr<Serial>> Serial::new_unique(uint8_t idx, SerialConfig const& config) {
+    auto spec = dtb::try_borrow_serial(idx);
+    if (!spec) {
+        return std::unexpected(spec.error());
+    }
+    std::unique_ptr<Serial> serial(new (std::nothrow) Serial(std::move(*spec), config));
+    TRY_ASSERT(serial, ExceptionType::NoMemory);
+    TRY(serial->_init());
+    return serial;
+}
+
+expected<std::shared_ptr<Serial>> Serial::new_shared(uint8_t idx, SerialConfig const& config) {
+    auto serial = Serial::new_unique(idx, config);
+    if (!serial) {
+        return std::unexpected(serial.error());
+    }
+    return std::shared_ptr<Serial>(std::move(*serial));
+}
+
+expected<void> Serial::_init() {
+    auto const& config = this->_config;
+#if defined(CONFIG_UART_WIDE_DATA)
+    TRY_ASSERT(8 == config.data_bits || 9 == config.data_bits, ExceptionType::InvalidArgument);
+#else
+    TRY_ASSERT(8 == config.data_bits, ExceptionType::InvalidArgument);
+#endif
+    // Power of 2 sizes keep ring index continuous when 32-bit positions wrap.
+    TRY_ASSERT(config.rx_chunks >= 2 && std::has_single_bit(config.rx_chunks)
+        && std::has_single_bit(config.rx_chunk) && std::has_single_bit(config.tx_size), ExceptionType::InvalidArgument);
+    TRY_ASSERT(config.baudrate > 0, ExceptionType::InvalidArgument);
+    TRY_ASSERT(device_is_ready(this->_spec->dev), ExceptionType::NoDev);
+
+    this->_word_size = 9 == config.data_bits ? sizeof(uint16_t) : sizeof(uint8_t);
+    uint32_t const bits = 1 + config.data_bits + (Parity::None == config.parity ? 0 : 1)
+        + (StopBits::Two == config.stop_bits ? 2 : 1);
+    this->_char_time = std::chrono::microseconds((bits * 1000000 + config.baudrate - 1) / config.baudrate);
+    this->_idle = config.idle.count() ? config.idle : std::max(this->_char_time * 7 / 2, MODBUS_MIN_IDLE);
+
+    this->_rx_size = config.rx_chunk * config.rx_chunks;
+    this->_tx_size = config.tx_size;
+    this->_rx_buf.reset(new (std::nothrow) uint8_t[this->_rx_size * this->_word_size]);
+    this->_tx_buf.reset(new (std::nothrow) uint8_t[this->_tx_size * this->_word_size]);
+    TRY_ASSERT(this->_rx_buf && this->_tx_buf, ExceptionType::NoMemory);
+
+    struct uart_config const uart_config = {
+        .baudrate = config.baudrate,
+        .parity = static_cast<uint8_t>(Parity::Odd == config.parity ? UART_CFG_PARITY_ODD
+            : Parity::Even == config.parity ? UART_CFG_PARITY_EVEN : UART_CFG_PARITY_NONE),
+        .stop_bits = static_cast<uint8_t>(StopBits::Two == config.stop_bits ? UART_CFG_STOP_BITS_2
+            : UART_CFG_STOP_BITS_1),
+        .data_bits = static_cast<uint8_t>(9 == config.data_bits ? UART_CFG_DATA_BITS_9 : UART_CFG_DATA_BITS_8),
+        .flow_ctrl = UART_CFG_FLOW_CTRL_NONE};
+    TRY_CCALL(uart_configure(this->_spec->dev, &uart_config));
+
+    k_timer_init(&this->_idle_timer, Serial::_on_idle_timer, nullptr);
+    k_timer_user_data_set(&this->_idle_timer, this);
+    TRY_CCALL(uart_callback_set(this->_spec->dev, Serial::_on_event, this));
+
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    TRY_CCALL(this->_rx_enable());
+    return {};
+}
+
+Serial::~Serial() {
+    bool is_rx_enabled = false;
+    bool is_tx_busy = false;
+    {
+        std::lock_guard<sys::SpinLock> lock(this->_lock);
+        this->_is_closing = true;
+        is_rx_enabled = this->_is_rx_enabled;
+        is_tx_busy = this->_tx_in_flight > 0;
+    }
+    k_timer_stop(&this->_idle_timer);
+    // Driver calls back until reception and transmission are finished.
+    sys::Deadline const deadline(CLOSE_TIMEOUT);
+    this->_events.clear(TxDone | RxDisabled);
+    if (is_tx_busy && 0 == uart_tx_abort(this->_spec->dev)) {
+        this->_events.wait(TxDone, deadline);
+    }
+    if (is_rx_enabled && 0 == uart_rx_disable(this->_spec->dev)) {
+        this->_events.wait(RxDisabled, deadline);
+    }
+    uart_callback_set(this->_spec->dev, nullptr, nullptr);
+}
+
+template <typename T>
+RingView<T> Serial::peek() const {
+    ASSERT(sizeof(T) == this->_word_size, ExceptionType::InvalidArgument, "Word type does not match data bits");
+    uint32_t const tail = this->_rx_tail.load(std::memory_order_relaxed);
+    return this->_view<T>(tail, this->_rx_head.load(std::memory_order_acquire));
+}
+
+template <typename T>
+RingView<T> Serial::wait(sys::timeout_t timeout) {
+    sys::Deadline const deadline(timeout);
+    while (true) {
+        this->_events.clear(RxData);
+        auto const view = this->peek<T>();
+        if (!view.empty() || !this->_events.wait(RxData, deadline)) {
+            return view;
+        }
+    }
+}
+
+template <typename T>
+std::optional<RingView<T>> Serial::wait_frame(sys::timeout_t timeout) {
+    ASSERT(sizeof(T) == this->_word_size, ExceptionType::InvalidArgument, "Word type does not match data bits");
+    sys::Deadline const deadline(timeout);
+    while (true) {
+        this->_events.clear(RxFrame);
+        {
+            std::lock_guard<sys::SpinLock> lock(this->_lock);
+            uint32_t const tail = this->_rx_tail.load(std::memory_order_relaxed);
+            // Frames already consumed by reader are dropped.
+            while (this->_frame_tail != this->_frame_head
+                && static_cast<int32_t>(this->_frame_ends[this->_frame_tail % SERIAL_MAX_FRAMES] - tail) <= 0)
+            {
+                this->_frame_tail += 1;
+            }
+            if (this->_frame_tail != this->_frame_head) {
+                return this->_view<T>(tail, this->_frame_ends[this->_frame_tail % SERIAL_MAX_FRAMES]);
+            }
+        }
+        if (!this->_events.wait(RxFrame, deadline)) {
+            return std::nullopt;
+        }
+    }
+}
+
+void Serial::consume(std::size_t count) {
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    uint32_t const tail = this->_rx_tail.load(std::memory_order_relaxed);
+    uint32_t const available = this->_rx_head.load(std::memory_order_relaxed) - tail;
+    this->_rx_tail.store(tail + std::min<std::size_t>(count, available), std::memory_order_release);
+    // Freed chunk goes to driver which is waiting for it, or reception is restarted after overrun.
+    if (this->_is_rx_buf_requested) {
+        this->_give_rx_buf();
+    } else if (!this->_is_rx_enabled && !this->_is_closing) {
+        if (0 != this->_rx_enable()) {
+            this->_errors.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Serial::clear() {
+    this->consume(this->_rx_size);
+}
+
+template <typename T>
+std::size_t Serial::write(std::span<T const> data) {
+    ASSERT(sizeof(T) == this->_word_size, ExceptionType::InvalidArgument, "Word type does not match data bits");
+    std::lock_guard<sys::SpinLock> lock(this->_lock);
+    uint32_t const free = this->_tx_size - (this->_tx_head - this->_tx_tail);
+    std::size_t const count = std::min<std::size_t>(data.size(), free);
+    uint32_t const start = this->_tx_head % this->_tx_size;
+    std::size_t const first = std::min<std::size_t>(count, this->_tx_size - start);
+    T* const ring = reinterpret_cast<T*>(this->_tx_buf.get());
+    std::memcpy(ring + start, data.data(), first * sizeof(T));
+    std::memcpy(ring, data.data() + first, (count - first) * sizeof(T));
+    this->_tx_head += count;
+    if (0 == this->_tx_in_flight && 0 != this->_tx_start()) {
+        this->_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    return count;
+}
+
+template <typename T>
+bool Serial::write_all(std::span<T const> data, sys::timeout_t timeout) {
+    sys::Deadline const deadline(timeout);
+    while (true) {
+        this->_events.clear(TxDone);
+        data = data.subspan(this->write(data));
+        if (data.empty()) {
+            return true;
+        }
+        if (!this->_events.wait(TxDone, deadline)) {
+            return false;
+        }
+    }
+}
+
+bool Serial::flush(sys::timeout_t timeout) {
+    sys::Deadline const deadline(timeout);
+    while (true) {
+        this->_events.clear(TxDone);
+        {
+            std::lock_guard<sys::SpinLock> lock(this->_lock);
+            if (this->_tx_head == this->_tx_tail) {
+                return true;
+            }
+        }
+        if (!this->_events.wait(TxDone, deadline)) {
+            return false;
+        }
+    }
+}
+
+template <typename T>
+RingView<T> Serial::_view(uint32_t from, uint32_t to) const {
+    T const* const ring = reinterpret_cast<T const*>(this->_rx_buf.get());
+    uint32_t const start = from % this->_rx_size;
+    uint32_t const count = to - from;
+    uint32_t const first = std::min(count, this->_rx_size - start);
+    return RingView<T>{std::span<T const>(ring + start, first), std::span<T const>(ring, count - first)};
+}
+
+std::span<uint8_t> Serial::_next_rx_region() {
+    // Region ends at chunk end, chunk is free when reader consumed its previous round.
+    uint32_t const start = this->_rx_given;
+    uint32_t const end = start - start % this->_config.rx_chunk + this->_config.rx_chunk;
+    if (end - this->_rx_tail.load(std::memory_order_relaxed) > this->_rx_size) {
+        return {};
+    }
+    this->_rx_given = end;
+    return std::span<uint8_t>(this->_rx_buf.get() + (start % this->_rx_size) * this->_word_size,
+        (end - start) * this->_word_size);
+}
+
+int Serial::_rx_enable() {
+    // After stop reception continues right after received data, not from chunk start.
+    uint32_t const head = this->_rx_head.load(std::memory_order_relaxed);
+    this->_rx_given = head;
+    auto const region = this->_next_rx_region();
+    if (region.empty()) {
+        // Ring is full, consume() enables reception.
+        return 0;
+    }
+    int const rc = rx_enable(this->_spec->dev, region, this->_word_size, this->_idle.count());
+    if (0 != rc) {
+        this->_rx_given = head;
+        return rc;
+    }
+    this->_is_rx_enabled = true;
+    return 0;
+}
+
+void Serial::_give_rx_buf() {
+    uint32_t const given = this->_rx_given;
+    auto const region = this->_next_rx_region();
+    if (region.empty()) {
+        // Driver keeps receiving into current chunk meanwhile, consume() responds later.
+        this->_is_rx_buf_requested = true;
+        return;
+    }
+    this->_is_rx_buf_requested = false;
+    if (0 != rx_buf_rsp(this->_spec->dev, region, this->_word_size)) {
+        // Reception is already stopped, it is restarted from received data.
+        this->_rx_given = given;
+    }
+}
+
+void Serial::_on_rx(std::size_t words) {
+    uint32_t const head = this->_rx_head.load(std::memory_order_relaxed) + words;
+    this->_rx_head.store(head, std::memory_order_release);
+    this->_events.post(RxData);
+    if (0 == head % this->_config.rx_chunk) {
+        // Chunk is full, data may continue in next chunk. If it does not, driver has nothing to report,
+        // so frame is ended by timer: next chunk is filled or line goes idle before it expires.
+        k_timer_start(&this->_idle_timer, K_USEC((this->_char_time * this->_config.rx_chunk + this->_idle).count()),
+            K_NO_WAIT);
+    } else {
+        // Driver reports data before chunk end only when line is idle.
+        k_timer_stop(&this->_idle_timer);
+        this->_push_frame_end();
+    }
+}
+
+void Serial::_on_rx_disabled() {
+    this->_is_rx_enabled = false;
+    if (this->_is_rx_buf_requested) {
+        this->_overruns.fetch_add(1, std::memory_order_relaxed);
+        this->_is_rx_buf_requested = false;
+    }
+    this->_events.post(RxDisabled);
+    if (!this->_is_closing && 0 != this->_rx_enable()) {
+        this->_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Serial::_push_frame_end() {
+    uint32_t const head = this->_rx_head.load(std::memory_order_relaxed);
+    if (this->_frame_tail != this->_frame_head) {
+        uint32_t& last = this->_frame_ends[(this->_frame_head - 1) % SERIAL_MAX_FRAMES];
+        if (last == head) {
+            return;
+        }
+        if (SERIAL_MAX_FRAMES == this->_frame_head - this->_frame_tail) {
+            // Reader is behind by many frames, the last one is extended.
+            last = head;
+            this->_events.post(RxFrame);
+            return;
+        }
+    }
+    this->_frame_ends[this->_frame_head % SERIAL_MAX_FRAMES] = head;
+    this->_frame_head += 1;
+    this->_frames.fetch_add(1, std::memory_order_relaxed);
+    this->_events.post(RxFrame);
+}
+
+int Serial::_tx_start() {
+    uint32_t const start = this->_tx_tail % this->_tx_size;
+    uint32_t const count = std::min(this->_tx_head - this->_tx_tail, this->_tx_size - start);
+    if (0 == count) {
+        return 0;
+    }
+    int const rc = tx(this->_spec->dev, this->_tx_buf.get() + start * this->_word_size, count, this->_word_size);
+    if (0 == rc) {
+        this->_tx_in_flight = count;
+    }
+    return rc;
+}
+
+void Serial::_on_tx_done(std::optional<std::size_t> words) {
+    this->_tx_tail += std::min<std::size_t>(words.value_or(this->_tx_in_flight), this->_tx_in_flight);
+    this->_tx_in_flight = 0;
+    if (this->_is_closing) {
+        // Aborted data is dropped.
+        this->_tx_tail = this->_tx_head;
+    } else if (0 != this->_tx_start()) {
+        this->_errors.fetch_add(1, std::memory_order_relaxed);
+    }
+    this->_events.post(TxDone);
+}
+
+void Serial::_on_event(struct device const* dev, struct uart_event* event, void* user_data) {
+    auto* const self = static_cast<Serial*>(user_data);
+    std::lock_guard<sys::SpinLock> lock(self->_lock);
+    switch (event->type) {
+    case UART_TX_DONE:
+        self->_on_tx_done(std::nullopt);
+        break;
+    case UART_TX_ABORTED:
+        self->_on_tx_done(event->data.tx.len / self->_word_size);
+        break;
+    case UART_RX_RDY:
+        self->_on_rx(event->data.rx.len / self->_word_size);
+        break;
+    case UART_RX_BUF_REQUEST:
+        self->_give_rx_buf();
+        break;
+    case UART_RX_STOPPED:
+        self->_errors.fetch_add(1, std::memory_order_relaxed);
+        break;
+    case UART_RX_DISABLED:
+        self->_on_rx_disabled();
+        break;
+    default:
+        break;
+    }
+}
+
+void Serial::_on_idle_timer(struct k_timer* timer) {
+    auto* const self = static_cast<Serial*>(k_timer_user_data_get(timer));
+    std::lock_guard<sys::SpinLock> lock(self->_lock);
+    self->_push_frame_end();
+}
+
+template RingView<uint8_t> Serial::peek<uint8_t>() const;
+template RingView<uint16_t> Serial::peek<uint16_t>() const;
+template RingView<uint8_t> Serial::wait<uint8_t>(sys::timeout_t);
+template RingView<uint16_t> Serial::wait<uint16_t>(sys::timeout_t);
+template std::optional<RingView<uint8_t>> Serial::wait_frame<uint8_t>(sys::timeout_t);
+template std::optional<RingView<uint16_t>> Serial::wait_frame<uint16_t>(sys::timeout_t);
+template std::size_t Serial::write<uint8_t>(std::span<uint8_t const>);
+template std::size_t Serial::write<uint16_t>(std::span<uint16_t const>);
+template bool Serial::write_all<uint8_t>(std::span<uint8_t const>, sys::timeout_t);
+template bool Serial::write_all<uint16_t>(std::span<uint16_t const>, sys::timeout_t);
+
+} // namespace periph
+} // namespace mlplc
+
+#endif // CONFIG_UART_ASYNC_API
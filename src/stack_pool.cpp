@@ -0,0 +1,98 @@
+#include <mlplc/sys/stack_pool.hpp>
+
+#include <zephyr/init.h>
+
+#include <atomic>
+
+#if defined(CONFIG_MLPLC_STACK_POOL)
+
+namespace mlplc {
+namespace sys {
+
+namespace {
+
+K_THREAD_STACK_ARRAY_DEFINE(stacks_1k, CONFIG_MLPLC_STACK_POOL_1K_COUNT, 1024);
+K_THREAD_STACK_ARRAY_DEFINE(stacks_2k, CONFIG_MLPLC_STACK_POOL_2K_COUNT, 2048);
+K_THREAD_STACK_ARRAY_DEFINE(stacks_4k, CONFIG_MLPLC_STACK_POOL_4K_COUNT, 4096);
+
+/** Size class of stacks. Slab blocks are elements of stack array,
+ * so each block keeps stack alignment and guard requirements.
+ */
+struct StackClass {
+    void* buf;
+    std::size_t stack_size;
+    std::size_t block_size;
+    uint32_t count;
+    struct k_mem_slab slab{};
+    std::atomic<uint32_t> max_used = 0;
+
+    bool owns(k_thread_stack_t const* stack) const {
+        auto const* begin = static_cast<uint8_t const*>(this->buf);
+        auto const* p = reinterpret_cast<uint8_t const*>(stack);
+        return p >= begin && p < begin + this->block_size * this->count;
+    }
+};
+
+std::array<StackClass, STACK_POOL_CLASS_COUNT> stack_classes = {{
+    {stacks_1k, 1024, K_THREAD_STACK_LEN(1024), CONFIG_MLPLC_STACK_POOL_1K_COUNT},
+    {stacks_2k, 2048, K_THREAD_STACK_LEN(2048), CONFIG_MLPLC_STACK_POOL_2K_COUNT},
+    {stacks_4k, 4096, K_THREAD_STACK_LEN(4096), CONFIG_MLPLC_STACK_POOL_4K_COUNT},
+}};
+
+int stack_pool_init() {
+    for (auto& cls : stack_classes) {
+        k_mem_slab_init(&cls.slab, cls.buf, cls.block_size, cls.count);
+    }
+    return 0;
+}
+
+SYS_INIT(stack_pool_init, PRE_KERNEL_1, 0);
+
+} // namespace
+
+std::optional<PooledStack> stack_pool_alloc(std::size_t size) {
+    for (auto& cls : stack_classes) {
+        if (cls.stack_size < size) {
+            continue;
+        }
+        void* block = nullptr;
+        if (0 == k_mem_slab_alloc(&cls.slab, &block, K_NO_WAIT)) {
+            uint32_t const used = k_mem_slab_num_used_get(&cls.slab);
+            uint32_t max_used = cls.max_used;
+            while (used > max_used && !cls.max_used.compare_exchange_weak(max_used, used)) {}
+            return PooledStack{static_cast<k_thread_stack_t*>(block), cls.stack_size};
+        }
+    }
+    return std::nullopt;
+}
+
+void stack_pool_free(k_thread_stack_t* stack) {
+    for (auto& cls : stack_classes) {
+        if (cls.owns(stack)) {
+            k_mem_slab_free(&cls.slab, stack);
+            return;
+        }
+    }
+    // Called from shared_ptr deleter, which must not throw.
+    __ASSERT(false, "Stack is not from pool");
+    k_panic();
+}
+
+std::array<StackClassStats, STACK_POOL_CLASS_COUNT> stack_pool_stats() {
+    std::array<StackClassStats, STACK_POOL_CLASS_COUNT> stats{};
+    for (std::size_t i = 0; i < STACK_POOL_CLASS_COUNT; i++) {
+        auto& cls = stack_classes[i];
+        stats[i] = StackClassStats{
+            .stack_size = cls.stack_size,
+            .count = cls.count,
+            .used = k_mem_slab_num_used_get(&cls.slab),
+            .max_used = cls.max_used,
+        };
+    }
+    return stats;
+}
+
+} // namespace sys
+} // namespace mlplc
+
+#endif // CONFIG_MLPLC_STACK_POOL
@@ -33,8 +33,22 @@ static void print_all_heaps(void)
 	}
 }
 
+#if defined(CONFIG_MLPLC_STACK_POOL)
+static void print_stack_pool(void)
+{
+	printk("Thread stack pool:\n");
+	for (auto const& cls : stack_pool_stats()) {
+		printk("\t%zu bytes: used %u, max used %u of %u\n",
+			cls.stack_size, cls.used, cls.max_used, cls.count);
+	}
+}
+#endif
+
 std::size_t mem_usage() {
     print_all_heaps();
+#if defined(CONFIG_MLPLC_STACK_POOL)
+    print_stack_pool();
+#endif
     return 0;
 }
 
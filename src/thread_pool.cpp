@@ -0,0 +1,145 @@
+#include <mlplc/sys/thread_pool.hpp>
+
+#include <string>
+
+namespace mlplc {
+namespace sys {
+
+TaskHandle& TaskHandle::operator= (TaskHandle&& other) noexcept {
+    if (this != &other) {
+        if (this->_pool) {
+            this->_pool->_unref(this->_idx);
+        }
+        this->_pool = std::exchange(other._pool, nullptr);
+        this->_idx = other._idx;
+    }
+    return *this;
+}
+
+TaskHandle::~TaskHandle() {
+    if (this->_pool) {
+        this->_pool->_unref(this->_idx);
+    }
+}
+
+bool TaskHandle::wait(timeout_t timeout) {
+    ASSERT(this->_pool, ExceptionType::ObjectMoved);
+    auto& slot = this->_pool->_slots[this->_idx];
+    return 0 != slot.done.wait(ThreadPool::EVENT_DONE, Deadline(timeout));
+}
+
+bool TaskHandle::is_done() {
+    return this->wait(std::chrono::microseconds(0));
+}
+
+std::optional<std::string> TaskHandle::error() const {
+    ASSERT(this->_pool, ExceptionType::ObjectMoved);
+    return this->_pool->_slots[this->_idx].error;
+}
+
+ThreadPool::ThreadPool(
+    std::string_view name,
+    std::size_t workers,
+    std::size_t max_tasks,
+    std::size_t stack_size,
+    uint8_t priority)
+{
+    ASSERT(workers > 0, ExceptionType::InvalidArgument, "Pool without workers");
+    ASSERT(max_tasks > 0 && max_tasks <= MAX_TASKS, ExceptionType::NoMemory, "Too many pool tasks: ", max_tasks);
+
+    this->_slots = std::make_unique<_private::PoolSlot[]>(max_tasks);
+    this->_free_buf = std::make_unique<uint8_t[]>(max_tasks);
+    // Stop requests are queued in addition to tasks.
+    this->_pending_buf = std::make_unique<uint8_t[]>(max_tasks + workers);
+    k_msgq_init(&this->_free, reinterpret_cast<char*>(this->_free_buf.get()), sizeof(uint8_t), max_tasks);
+    k_msgq_init(&this->_pending, reinterpret_cast<char*>(this->_pending_buf.get()), sizeof(uint8_t), max_tasks + workers);
+
+    for (std::size_t i = 0; i < max_tasks; i++) {
+        uint8_t const idx = i;
+        CCALL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+    }
+
+    this->_workers.reserve(workers);
+#if defined(CONFIG_CPP_EXCEPTIONS)
+    try {
+#endif
+        for (std::size_t i = 0; i < workers; i++) {
+            std::string const worker_name = std::string(name) + std::to_string(i);
+            auto worker = std::make_unique<Thread<>>(worker_name, [this]() { this->_run(); }, stack_size, priority);
+            worker->start();
+            // Never throws, place is reserved.
+            this->_workers.push_back(std::move(worker));
+        }
+#if defined(CONFIG_CPP_EXCEPTIONS)
+    } catch (...) {
+        // Started workers run on this pool, they must finish before it is torn down.
+        this->_stop_workers();
+        throw;
+    }
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+    this->_stop_workers();
+}
+
+void ThreadPool::_stop_workers() {
+    for (std::size_t i = 0; i < this->_workers.size(); i++) {
+        CCALL_UNTIL(k_msgq_put(&this->_pending, &STOP_IDX, K_FOREVER));
+    }
+    for (auto& worker : this->_workers) {
+        worker->join();
+    }
+}
+
+std::optional<TaskHandle> ThreadPool::submit(std::move_only_function<void()> func, timeout_t timeout) {
+    uint8_t idx = 0;
+    if (0 != k_msgq_get(&this->_free, &idx, Deadline(timeout).k_timeout())) {
+        return std::nullopt;
+    }
+
+    auto& slot = this->_slots[idx];
+    slot.func = std::move(func);
+    slot.error = std::nullopt;
+    slot.done.clear(EVENT_DONE);
+    slot.refs = 2;
+    // Never blocks, pending queue has place for every slot.
+    CCALL(k_msgq_put(&this->_pending, &idx, K_NO_WAIT));
+    return TaskHandle(this, idx);
+}
+
+void ThreadPool::_run() {
+    while (true) {
+        uint8_t idx = 0;
+        CCALL_UNTIL(k_msgq_get(&this->_pending, &idx, K_FOREVER));
+        if (STOP_IDX == idx) {
+            return;
+        }
+
+        auto& slot = this->_slots[idx];
+#if defined(CONFIG_CPP_EXCEPTIONS)
+        try {
+            slot.func();
+        } catch (std::exception const& ex) {
+            slot.error = std::string(ex.what());
+        } catch (...) {
+            slot.error = std::string("Unknown exception");
+        }
+#else
+        slot.func();
+#endif
+        // Captured state is destroyed by worker, not by last handle owner.
+        slot.func = nullptr;
+        slot.done.post(EVENT_DONE);
+        this->_unref(idx);
+    }
+}
+
+void ThreadPool::_unref(uint8_t idx) {
+    if (1 == this->_slots[idx].refs.fetch_sub(1)) {
+        CCALL_UNTIL(k_msgq_put(&this->_free, &idx, K_NO_WAIT));
+    }
+}
+
+} // namespace sys
+} // namespace mlplc
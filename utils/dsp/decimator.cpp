@@ -0,0 +1,131 @@
+#include "decimator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+namespace mlplc {
+namespace dsp {
+
+template <typename T>
+Decimator<T>::Decimator(DecimatorConfig const& config, Calibration const& calibration) :
+    // Configuration is clamped at run time, checks must not depend on assert being compiled in.
+    _ratio(std::max<uint16_t>(config.ratio, 1)),
+    _order(std::clamp<uint8_t>(config.order, 1, DECIMATOR_MAX_ORDER)),
+    _input_bits(std::clamp<uint8_t>(config.input_bits, 1, 16)),
+    _output_bits(std::clamp<uint8_t>(config.output_bits, 1, 8 * sizeof(T) - 1)),
+    _taps_size(0),
+    _gain(1)
+{
+    // Stages whose gain would not fit 32 bits are dropped.
+    uint8_t order = 0;
+    while (order < this->_order && this->_gain * this->_ratio <= (uint64_t(1) << 32)) {
+        this->_gain *= this->_ratio;
+        order += 1;
+    }
+    this->_order = std::max<uint8_t>(order, 1);
+
+    if (config.taps.empty()) {
+        // Droop of CIC in passband is about 1 - order * (pi * f)^2 / 6, f relative to output rate,
+        // [-a, 1 + 2a, -a] rises by 4a * (pi * f)^2, so a = order / 24.
+        int16_t const a = (this->_order * (1 << 14) + 12) / 24;
+        this->_taps[0] = -a;
+        this->_taps[1] = (1 << 14) + 2 * a;
+        this->_taps[2] = -a;
+        this->_taps_size = 3;
+    } else {
+        for (auto const tap : config.taps.first(std::min(config.taps.size(), DECIMATOR_MAX_TAPS))) {
+            this->_taps[this->_taps_size++] = tap;
+        }
+    }
+
+    // CIC output is below 2^(input_bits + gain_bits), FIR sum is below 2^15 times that.
+    int const gain_bits = std::bit_width(this->_gain - 1);
+    this->_pre_shift = std::max(0, this->_input_bits + gain_bits - 16);
+
+    this->set_calibration(calibration);
+}
+
+template <typename T>
+void Decimator<T>::set_calibration(Calibration const& calibration) {
+    this->_calibration = calibration;
+    if (0 == calibration.gain_q16) {
+        this->_multiplier = 0;
+        this->_shift = 0;
+        return;
+    }
+    // Output = fir * 2^pre_shift * 2^(output_bits - input_bits) * gain_q16 / 2^16 / (cic_gain * 2^14).
+    // Multiplier is normalized to [2^30, 2^31], product with 32-bit FIR sum fits 63 bits.
+    uint64_t const gain = std::abs(static_cast<int64_t>(calibration.gain_q16));
+    int s = 0;
+    while ((gain << s) < (this->_gain << 30)) {
+        s += 1;
+    }
+    int64_t const multiplier = ((gain << s) + this->_gain / 2) / this->_gain;
+    int const shift = s + 30 + this->_input_bits - this->_pre_shift - this->_output_bits;
+    this->_multiplier = calibration.gain_q16 < 0 ? -multiplier : multiplier;
+    this->_shift = std::clamp(shift, 1, 63);
+}
+
+template <typename T>
+void Decimator<T>::reset() {
+    this->_phase = 0;
+    this->_integrators.fill(0);
+    this->_combs.fill(0);
+    this->_history.fill(0);
+}
+
+template <typename T>
+std::size_t Decimator<T>::process(Channel<int16_t> in, std::span<T> out) {
+    std::size_t stored = 0;
+    uint8_t const order = this->_order;
+    for (std::size_t i = 0; i < in.size; i++) {
+        uint64_t x = static_cast<uint64_t>(static_cast<int64_t>(in[i]));
+        for (uint8_t k = 0; k < order; k++) {
+            this->_integrators[k] += x;
+            x = this->_integrators[k];
+        }
+        if (++this->_phase < this->_ratio) {
+            continue;
+        }
+        this->_phase = 0;
+        for (uint8_t k = 0; k < order; k++) {
+            uint64_t const y = x - this->_combs[k];
+            this->_combs[k] = x;
+            x = y;
+        }
+        T const value = this->_output(static_cast<int64_t>(x));
+        if (stored < out.size()) {
+            out[stored++] = value;
+        }
+    }
+    return stored;
+}
+
+template <typename T>
+T Decimator<T>::_output(int64_t cic) {
+    for (std::size_t k = this->_taps_size - 1; k > 0; k--) {
+        this->_history[k] = this->_history[k - 1];
+    }
+    this->_history[0] = cic;
+    int64_t fir = 0;
+    for (std::size_t k = 0; k < this->_taps_size; k++) {
+        fir += this->_history[k] * this->_taps[k];
+    }
+
+    // Scaling and calibration are one multiply.
+    int64_t const product = (fir >> this->_pre_shift) * this->_multiplier;
+    int64_t const scaled = this->_shift < 63 ? (product + (int64_t(1) << (this->_shift - 1))) >> this->_shift : 0;
+    int64_t const value = scaled + this->_calibration.offset;
+    if constexpr (sizeof(T) == sizeof(q15_t)) {
+        return sat_q15(static_cast<int32_t>(std::clamp<int64_t>(value, INT32_MIN, INT32_MAX)));
+    } else {
+        return sat_q31(value);
+    }
+}
+
+template class Decimator<q15_t>;
+template class Decimator<q31_t>;
+
+} // namespace dsp
+} // namespace mlplc
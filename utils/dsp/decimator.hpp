@@ -0,0 +1,106 @@
+#pragma once
+
+#include "fixed.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mlplc {
+namespace dsp {
+
+constexpr std::size_t DECIMATOR_MAX_ORDER = 4;
+constexpr std::size_t DECIMATOR_MAX_TAPS = 16;
+
+/// Calibration of channel, applied by output stage of Decimator: output = value * gain + offset.
+struct Calibration {
+    /// Gain, Q16: 65536 is 1. Negative gain inverts channel.
+    int32_t gain_q16 = 1 << 16;
+    /// Offset in output LSB, added after gain.
+    int32_t offset = 0;
+};
+
+/// Values out of range are clamped: order is reduced until ratio^order fits 2^32, extra taps are ignored.
+struct DecimatorConfig {
+    /// Input samples per output sample, at least 1.
+    uint16_t ratio = 16;
+    /// CIC stages, 1 to DECIMATOR_MAX_ORDER. ratio^order must not exceed 2^32.
+    uint8_t order = 3;
+    /// Input samples are below 2^input_bits in magnitude, e.g. 12 for 12-bit ADC, up to 16.
+    uint8_t input_bits = 12;
+    /// Output samples are scaled to 2^output_bits full scale, up to 15 for q15_t and 31 for q31_t output.
+    uint8_t output_bits = 15;
+    /** FIR compensator taps, Q14 with sum of 1 and sum of magnitudes below 2, at most DECIMATOR_MAX_TAPS.
+     * Empty gives 3-tap compensator of CIC droop for order. Taps are copied.
+     */
+    std::span<int16_t const> taps = {};
+};
+
+/** Streaming oversampling decimator of one channel: CIC filter, short FIR compensator of CIC passband droop
+ * and output stage scaling to output word with calibration - one pass over input, no float.
+ * Decimation by ratio R adds log2(R)/2 effective bits for white noise, e.g. 12-bit ADC with R = 16 gives
+ * 14 bits. Integrators, combs and FIR history are kept across blocks, so block boundaries do not matter and
+ * block size needs not be multiple of ratio.
+ */
+template <typename T>
+class Decimator {
+public:
+    explicit Decimator(DecimatorConfig const& config, Calibration const& calibration = {});
+
+    /** Filter block of raw samples, e.g. channel of AnalogBlock via Channel::interleaved().
+     * @param out Place for outputs(in.size) samples, samples which do not fit are dropped.
+     * @return Count of stored output samples.
+     */
+    std::size_t process(Channel<int16_t> in, std::span<T> out);
+
+    /// Count of output samples produced by next inputs samples.
+    std::size_t outputs(std::size_t inputs) const {
+        return (this->_phase + inputs) / this->_ratio;
+    }
+
+    /// Change calibration on the fly, filter state is kept.
+    void set_calibration(Calibration const& calibration);
+
+    Calibration calibration() const {
+        return this->_calibration;
+    }
+
+    uint16_t ratio() const {
+        return this->_ratio;
+    }
+
+    /// Clear filter state, next outputs settle again for order + taps output samples.
+    void reset();
+
+private:
+    uint16_t _ratio;
+    uint8_t _order;
+    uint8_t _input_bits;
+    uint8_t _output_bits;
+    uint8_t _taps_size;
+    std::array<int16_t, DECIMATOR_MAX_TAPS> _taps{};
+    Calibration _calibration{};
+
+    /// CIC gain ratio^order.
+    uint64_t _gain;
+    /// FIR sum is shifted right by _pre_shift to 32 bits, then multiplied by _multiplier and shifted by _shift.
+    uint8_t _pre_shift;
+    uint8_t _shift = 0;
+    int64_t _multiplier = 0;
+
+    uint16_t _phase = 0;
+    /// Integrators and combs wrap modulo 2^64, result is exact as long as CIC output fits.
+    std::array<uint64_t, DECIMATOR_MAX_ORDER> _integrators{};
+    std::array<uint64_t, DECIMATOR_MAX_ORDER> _combs{};
+    /// CIC outputs, the newest first.
+    std::array<int64_t, DECIMATOR_MAX_TAPS> _history{};
+
+    T _output(int64_t cic);
+};
+
+extern template class Decimator<q15_t>;
+extern template class Decimator<q31_t>;
+
+} // namespace dsp
+} // namespace mlplc
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "fixed.hpp"
+#include "metering.hpp"
+#include "decimator.hpp"
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// Cortex-M4/M7/M33 SIMD intrinsics, MLPLC_DSP_PORTABLE forces portable code, e.g. for comparison on target.
+#if defined(__ARM_FEATURE_DSP) && !defined(MLPLC_DSP_PORTABLE)
+#define MLPLC_DSP_SIMD 1
+#else
+#define MLPLC_DSP_SIMD 0
+#endif
+
+namespace mlplc {
+namespace dsp {
+
+/// Fixed point 1.15, full scale is [-1, 1).
+using q15_t = int16_t;
+/// Fixed point 1.31, full scale is [-1, 1).
+using q31_t = int32_t;
+
+constexpr q15_t sat_q15(int32_t x) {
+    if (x > std::numeric_limits<q15_t>::max()) {
+        return std::numeric_limits<q15_t>::max();
+    }
+    if (x < std::numeric_limits<q15_t>::min()) {
+        return std::numeric_limits<q15_t>::min();
+    }
+    return static_cast<q15_t>(x);
+}
+
+constexpr q31_t sat_q31(int64_t x) {
+    if (x > std::numeric_limits<q31_t>::max()) {
+        return std::numeric_limits<q31_t>::max();
+    }
+    if (x < std::numeric_limits<q31_t>::min()) {
+        return std::numeric_limits<q31_t>::min();
+    }
+    return static_cast<q31_t>(x);
+}
+
+/// Floor of square root, bit by bit - no division and no float.
+constexpr uint32_t isqrt64(uint64_t x) {
+    uint64_t result = 0;
+    uint64_t bit = uint64_t(1) << 62;
+    while (bit > x) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (x >= result + bit) {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+/** Samples of one channel: every stride-th sample starting from data.
+ * Channel of interleaved ADC block is taken in place, without copying.
+ */
+template <typename T>
+struct Channel {
+    T const* data = nullptr;
+    std::size_t size = 0;
+    std::size_t stride = 1;
+
+    constexpr Channel() = default;
+
+    constexpr Channel(T const* data, std::size_t size, std::size_t stride = 1) :
+        data(data),
+        size(size),
+        stride(stride)
+    {}
+
+    constexpr Channel(std::span<T const> samples) :
+        data(samples.data()),
+        size(samples.size())
+    {}
+
+    /// Channel of block interleaved by channel, e.g. periph::AnalogBlock::samples().
+    static constexpr Channel interleaved(std::span<T const> block, std::size_t channels, std::size_t channel) {
+        return Channel(block.data() + channel, block.size() / channels, channels);
+    }
+
+    constexpr T operator[] (std::size_t i) const {
+        return this->data[i * this->stride];
+    }
+};
+
+} // namespace dsp
+} // namespace mlplc
@@ -0,0 +1,107 @@
+#include "metering.hpp"
+
+#include <cstring>
+
+#if MLPLC_DSP_SIMD
+#include <arm_acle.h>
+#endif
+
+namespace mlplc {
+namespace dsp {
+
+namespace {
+
+#if MLPLC_DSP_SIMD
+/// Two adjacent q15 samples in one register, unaligned access is allowed on Cortex-M4.
+inline int16x2_t load_pair(q15_t const* p) {
+    int16x2_t pair;
+    std::memcpy(&pair, p, sizeof(pair));
+    return pair;
+}
+#endif
+
+} // namespace
+
+int64_t sum_squares_q15(Channel<q15_t> x) {
+    int64_t acc = 0;
+    std::size_t i = 0;
+#if MLPLC_DSP_SIMD
+    if (1 == x.stride) {
+        // SMLALD: two 16x16 multiplies and 64-bit accumulate per instruction.
+        for (; i + 4 <= x.size; i += 4) {
+            int16x2_t const a = load_pair(x.data + i);
+            int16x2_t const b = load_pair(x.data + i + 2);
+            acc = __smlald(a, a, acc);
+            acc = __smlald(b, b, acc);
+        }
+    }
+#endif
+    for (; i < x.size; i++) {
+        int32_t const v = x[i];
+        acc += v * v;
+    }
+    return acc;
+}
+
+int64_t sum_squares_q31(Channel<q31_t> x) {
+    int64_t acc = 0;
+    for (std::size_t i = 0; i < x.size; i++) {
+        int64_t const v = x[i];
+        acc += (v * v) >> 14;
+    }
+    return acc;
+}
+
+int64_t sum_products_q15(Channel<q15_t> a, Channel<q15_t> b) {
+    int64_t acc = 0;
+    std::size_t i = 0;
+#if MLPLC_DSP_SIMD
+    if (1 == a.stride && 1 == b.stride) {
+        for (; i + 4 <= a.size; i += 4) {
+            acc = __smlald(load_pair(a.data + i), load_pair(b.data + i), acc);
+            acc = __smlald(load_pair(a.data + i + 2), load_pair(b.data + i + 2), acc);
+        }
+    } else if (2 == a.stride && 2 == b.stride && b.data == a.data + 1) {
+        // Adjacent channels of two-channel block: each word is (a, b) pair, SMLALDX gives a*b + b*a.
+        int64_t acc2 = 0;
+        for (; i + 2 <= a.size; i += 2) {
+            acc2 = __smlaldx(load_pair(a.data + 2 * i), load_pair(a.data + 2 * i), acc2);
+            acc2 = __smlaldx(load_pair(a.data + 2 * i + 2), load_pair(a.data + 2 * i + 2), acc2);
+        }
+        acc = acc2 / 2;
+    }
+#endif
+    for (; i < a.size; i++) {
+        acc += static_cast<int32_t>(a[i]) * b[i];
+    }
+    return acc;
+}
+
+int64_t sum_products_q31(Channel<q31_t> a, Channel<q31_t> b) {
+    int64_t acc = 0;
+    for (std::size_t i = 0; i < a.size; i++) {
+        acc += (static_cast<int64_t>(a[i]) * b[i]) >> 14;
+    }
+    return acc;
+}
+
+int64_t sum_q15(Channel<q15_t> x) {
+    int64_t acc = 0;
+    std::size_t i = 0;
+#if MLPLC_DSP_SIMD
+    if (1 == x.stride) {
+        // Multiply by packed (1, 1) sums two samples per instruction.
+        int16x2_t const ones = 0x00010001;
+        for (; i + 2 <= x.size; i += 2) {
+            acc = __smlald(load_pair(x.data + i), ones, acc);
+        }
+    }
+#endif
+    for (; i < x.size; i++) {
+        acc += x[i];
+    }
+    return acc;
+}
+
+} // namespace dsp
+} // namespace mlplc
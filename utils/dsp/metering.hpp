@@ -0,0 +1,215 @@
+#pragma once
+
+#include "fixed.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace mlplc {
+namespace dsp {
+
+/** Block metering kernels.
+ * Sums are kept in 64-bit accumulators without intermediate rounding, so windows of any practical length
+ * (e.g. 20 mains periods at 10 kHz) are summed exactly, and sums of several blocks may be added together.
+ * Contiguous q15 channels are processed two samples per instruction with SIMD multiply-accumulate.
+ */
+
+/// Sum of x^2, Q30.
+int64_t sum_squares_q15(Channel<q15_t> x);
+
+/// Sum of x^2 with 14 LSB of each square dropped, Q48. Does not overflow for up to 2^15 - 1 samples of full scale.
+int64_t sum_squares_q31(Channel<q31_t> x);
+
+/// Sum of a*b, Q30. Mean of products of voltage and current samples is active power.
+int64_t sum_products_q15(Channel<q15_t> a, Channel<q15_t> b);
+
+/// Sum of a*b with 14 LSB of each product dropped, Q48. Does not overflow for up to 2^15 - 1 samples of full scale.
+int64_t sum_products_q31(Channel<q31_t> a, Channel<q31_t> b);
+
+/// Sum of x, for DC offset estimation.
+int64_t sum_q15(Channel<q15_t> x);
+
+/// RMS from sum of squares of count samples, see sum_squares_q15().
+constexpr q15_t rms_from_sum_q15(int64_t sum_squares, std::size_t count) {
+    return count ? sat_q15(isqrt64(static_cast<uint64_t>(sum_squares) / count)) : 0;
+}
+
+/// RMS from sum of squares of count samples, see sum_squares_q31().
+constexpr q31_t rms_from_sum_q31(int64_t sum_squares, std::size_t count) {
+    return count ? sat_q31(isqrt64((static_cast<uint64_t>(sum_squares) / count) << 14)) : 0;
+}
+
+/// Mean of products from sum, see sum_products_q15(). Result is Q31.
+constexpr q31_t mean_from_sum_q15(int64_t sum_products, std::size_t count) {
+    return count ? sat_q31(sum_products / static_cast<int64_t>(count) * 2) : 0;
+}
+
+/// Mean of products from sum, see sum_products_q31(). Result is Q31.
+constexpr q31_t mean_from_sum_q31(int64_t sum_products, std::size_t count) {
+    return count ? sat_q31(sum_products / static_cast<int64_t>(count) >> 17) : 0;
+}
+
+static inline q15_t rms_q15(Channel<q15_t> x) {
+    return rms_from_sum_q15(sum_squares_q15(x), x.size);
+}
+
+static inline q31_t rms_q31(Channel<q31_t> x) {
+    return rms_from_sum_q31(sum_squares_q31(x), x.size);
+}
+
+/// Mean of a*b, Q31 - active power in units of full scale voltage * full scale current.
+static inline q31_t power_q15(Channel<q15_t> a, Channel<q15_t> b) {
+    return mean_from_sum_q15(sum_products_q15(a, b), a.size);
+}
+
+static inline q31_t power_q31(Channel<q31_t> a, Channel<q31_t> b) {
+    return mean_from_sum_q31(sum_products_q31(a, b), a.size);
+}
+
+/** Energy as running sum of sample products, see sum_products_q15().
+ * Kept in Q15 with carried remainder, so nothing is lost and 64 bits do not overflow for centuries.
+ * Energy in physical units is value * full scale power / sample rate.
+ */
+class EnergyAccumulator {
+public:
+    void add(int64_t sum_products_q30) {
+        this->_frac += sum_products_q30;
+        this->_q15 += this->_frac >> 15;
+        this->_frac &= (1 << 15) - 1;
+    }
+
+    /// Sum of products, Q15.
+    int64_t value_q15() const {
+        return this->_q15;
+    }
+
+    void reset() {
+        this->_q15 = 0;
+        this->_frac = 0;
+    }
+
+private:
+    int64_t _q15 = 0;
+    int64_t _frac = 0;
+};
+
+/** DC offset removal by one-pole tracker: dc += (x - dc) / 2^shift, output is x - dc.
+ * Time constant is 2^shift samples, it must be much longer than signal period, otherwise
+ * signal leaks into tracked offset. State is kept across blocks, so blocks form continuous stream.
+ * Offset settles exactly for shift up to 16, longer time constants leave up to 2^(shift - 17) LSB.
+ */
+template <typename T>
+class DcRemover {
+public:
+    explicit DcRemover(uint8_t shift = 14) :
+        _shift(shift)
+    {}
+
+    /// Output may be the same memory as contiguous input.
+    void process(Channel<T> in, std::span<T> out) {
+        // Rounded steps settle symmetrically around offset of either sign.
+        int64_t const half = (int64_t(1) << this->_shift) >> 1;
+        for (std::size_t i = 0; i < in.size; i++) {
+            int64_t const x = in[i];
+            this->_dc += ((x << 16) - this->_dc + half) >> this->_shift;
+            out[i] = saturate(x - this->_dc_rounded());
+        }
+    }
+
+    T dc() const {
+        return static_cast<T>(this->_dc_rounded());
+    }
+
+    /// Start from known offset, e.g. calibration value, instead of settling from zero.
+    void reset(T dc = 0) {
+        this->_dc = static_cast<int64_t>(dc) << 16;
+    }
+
+private:
+    uint8_t _shift;
+    /// Q16 fraction below sample LSB keeps slow tracking exact.
+    int64_t _dc = 0;
+
+    int64_t _dc_rounded() const {
+        return (this->_dc + (1 << 15)) >> 16;
+    }
+
+    static T saturate(int64_t x) {
+        if constexpr (sizeof(T) == sizeof(q15_t)) {
+            return sat_q15(static_cast<int32_t>(x));
+        } else {
+            return sat_q31(x);
+        }
+    }
+};
+
+/** Rising zero crossings with hysteresis and sub-sample interpolation.
+ * Signal must fall below -hysteresis before next crossing counts, so noise near zero gives one crossing.
+ * State is kept across blocks, period spanning block boundary is measured exactly.
+ */
+template <typename T>
+class ZeroCross {
+public:
+    explicit ZeroCross(T hysteresis = 0) :
+        _hysteresis(hysteresis)
+    {}
+
+    /** Find crossings in block.
+     * @param positions Crossing positions relative to block start, Q16.16 samples. Crossing between
+     * last sample of previous block and first sample of this block is negative.
+     * @return Count of stored positions, crossings which do not fit are still measured.
+     */
+    std::size_t process(Channel<T> in, std::span<int32_t> positions = {}) {
+        std::size_t stored = 0;
+        for (std::size_t i = 0; i < in.size; i++) {
+            int64_t const x = in[i];
+            if (x < -static_cast<int64_t>(this->_hysteresis)) {
+                this->_is_armed = true;
+            } else if (this->_is_armed && x >= 0 && this->_prev < 0) {
+                // Linear interpolation between previous and current sample.
+                uint64_t const frac = (static_cast<uint64_t>(-this->_prev) << 16) / static_cast<uint64_t>(x - this->_prev);
+                uint64_t const cross = ((this->_sample + i - 1) << 16) + frac;
+                if (this->_count > 0) {
+                    this->_period_q16 = static_cast<uint32_t>(cross - this->_last_cross);
+                }
+                this->_last_cross = cross;
+                this->_count += 1;
+                this->_is_armed = false;
+                if (stored < positions.size()) {
+                    positions[stored++] = static_cast<int32_t>(cross - (this->_sample << 16));
+                }
+            }
+            this->_prev = x;
+        }
+        this->_sample += in.size;
+        return stored;
+    }
+
+    /// Length of last complete period, Q16.16 samples. 0 before second crossing.
+    uint32_t period_q16() const {
+        return this->_period_q16;
+    }
+
+    /// Rising crossings since reset.
+    uint32_t count() const {
+        return this->_count;
+    }
+
+    void reset() {
+        *this = ZeroCross(this->_hysteresis);
+    }
+
+private:
+    T _hysteresis;
+    bool _is_armed = false;
+    int64_t _prev = 0;
+    /// Index of first sample of next block since reset.
+    uint64_t _sample = 0;
+    uint64_t _last_cross = 0;
+    uint32_t _period_q16 = 0;
+    uint32_t _count = 0;
+};
+
+} // namespace dsp
+} // namespace mlplc
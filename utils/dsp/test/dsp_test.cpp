@@ -0,0 +1,267 @@
+/** Host test of dsp kernels against reference values.
+ * Block sums are compared exactly with plain loops, on contiguous, strided and interleaved channels and
+ * lengths which are not multiple of SIMD step, so the SIMD path on target must be bit-identical to the
+ * portable one. Derived values are compared with double precision references.
+ */
+#include <dsp/dsp.hpp>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <vector>
+
+using namespace mlplc::dsp;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(expr) check((expr), #expr, __FILE__, __LINE__)
+
+void check(bool ok, char const* expr, char const* file, int line) {
+    if (!ok) {
+        std::printf("%s:%d: check failed: %s\n", file, line, expr);
+        failures += 1;
+    }
+}
+
+bool near(double value, double reference, double tolerance) {
+    return std::abs(value - reference) <= tolerance;
+}
+
+/// Sine of amplitude and period in samples, phase in radians.
+template <typename T>
+std::vector<T> sine(std::size_t size, double amplitude, double period, double phase = 0, double offset = 0) {
+    std::vector<T> samples(size);
+    for (std::size_t i = 0; i < size; i++) {
+        double const x = offset + amplitude * std::sin(2 * std::numbers::pi * i / period + phase);
+        samples[i] = static_cast<T>(std::lround(x));
+    }
+    return samples;
+}
+
+template <typename T>
+Channel<T> channel(std::vector<T> const& samples) {
+    return Channel<T>(samples.data(), samples.size());
+}
+
+/// Two channels interleaved as in periph::AnalogBlock.
+template <typename T>
+std::vector<T> interleave(std::vector<T> const& a, std::vector<T> const& b) {
+    std::vector<T> block;
+    for (std::size_t i = 0; i < a.size(); i++) {
+        block.push_back(a[i]);
+        block.push_back(b[i]);
+    }
+    return block;
+}
+
+void test_sums() {
+    // Odd length leaves tail after SIMD steps of 4 and 2 samples.
+    std::size_t const size = 1001;
+    auto const a = sine<q15_t>(size, 32767, 97.3);
+    auto const b = sine<q15_t>(size, 20000, 97.3, 1.0, -3000);
+    auto const block = interleave(a, b);
+    Channel<q15_t> const ca(a);
+    Channel<q15_t> const cb(b);
+    auto const ia = Channel<q15_t>::interleaved(block, 2, 0);
+    auto const ib = Channel<q15_t>::interleaved(block, 2, 1);
+
+    int64_t squares = 0;
+    int64_t products = 0;
+    int64_t sum = 0;
+    for (std::size_t i = 0; i < size; i++) {
+        squares += int64_t(a[i]) * a[i];
+        products += int64_t(a[i]) * b[i];
+        sum += b[i];
+    }
+    CHECK(squares == sum_squares_q15(ca));
+    CHECK(squares == sum_squares_q15(ia));
+    CHECK(products == sum_products_q15(ca, cb));
+    CHECK(products == sum_products_q15(ia, ib));
+    CHECK(sum == sum_q15(cb));
+    CHECK(sum == sum_q15(ib));
+    for (std::size_t n = 0; n < 8; n++) {
+        int64_t expected = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            expected += int64_t(a[i]) * b[i];
+        }
+        CHECK(expected == sum_products_q15(Channel<q15_t>(a.data(), n), Channel<q15_t>(b.data(), n)));
+        CHECK(expected == sum_products_q15(Channel<q15_t>(block.data(), n, 2), Channel<q15_t>(block.data() + 1, n, 2)));
+    }
+
+    // Full scale q31 up to 2^15 - 1 samples must not overflow.
+    std::vector<q31_t> const full(32767, INT32_MIN);
+    int64_t const full_squares = sum_squares_q31(channel(full));
+    CHECK(full_squares == int64_t(32767) * ((int64_t(INT32_MIN) * INT32_MIN) >> 14));
+    CHECK(full_squares > 0);
+    CHECK(sum_products_q31(channel(full), channel(full)) == full_squares);
+}
+
+void test_rms_power() {
+    // 10 whole periods, so means of sine are exact in double.
+    std::size_t const size = 2000;
+    double const amplitude = 16384;
+    double const phase = std::numbers::pi / 3;
+    auto const u = sine<q15_t>(size, amplitude, 200);
+    auto const i = sine<q15_t>(size, amplitude, 200, -phase);
+
+    // Half of full scale sine: RMS is 0.5 / sqrt(2), power is 0.5 * 0.5 / 2 * cos(phase) of full scale.
+    CHECK(near(rms_q15(channel(u)), amplitude / std::numbers::sqrt2, 1));
+    CHECK(near(power_q15(channel(u), channel(i)), 0.125 * std::cos(phase) * 0x1p31, 0x1p31 * 1e-4));
+    CHECK(0 == rms_q15(Channel<q15_t>()));
+
+    std::vector<q31_t> u31(size);
+    std::vector<q31_t> i31(size);
+    for (std::size_t k = 0; k < size; k++) {
+        u31[k] = int32_t(u[k]) << 16;
+        i31[k] = int32_t(i[k]) << 16;
+    }
+    CHECK(near(rms_q31(channel(u31)), double(rms_q15(channel(u))) * 0x1p16, 0x1p16));
+    CHECK(near(power_q31(channel(u31), channel(i31)), power_q15(channel(u), channel(i)), 2));
+
+    // Sum of several blocks is the sum of the whole window.
+    Channel<q15_t> const first(u.data(), 777);
+    Channel<q15_t> const second(u.data() + 777, size - 777);
+    CHECK(sum_squares_q15(channel(u)) == sum_squares_q15(first) + sum_squares_q15(second));
+
+    EnergyAccumulator energy;
+    energy.add(sum_products_q15(first, Channel<q15_t>(i.data(), 777)));
+    energy.add(sum_products_q15(second, Channel<q15_t>(i.data() + 777, size - 777)));
+    CHECK(energy.value_q15() == sum_products_q15(channel(u), channel(i)) >> 15);
+}
+
+void test_zero_cross() {
+    double const period = 160.25;
+    std::size_t const size = 4000;
+    auto const x = sine<q15_t>(size, 10000, period, 0.3);
+
+    // Odd block size, crossings fall on block boundaries.
+    ZeroCross<q15_t> zc(100);
+    std::vector<int32_t> positions(4);
+    std::size_t stored = 0;
+    std::size_t expected = 0;
+    for (std::size_t start = 0; start < size; start += 37) {
+        std::size_t const n = std::min<std::size_t>(37, size - start);
+        stored += zc.process(Channel<q15_t>(x.data() + start, n), positions);
+    }
+    // Rising crossings at (k - 0.3 / 2pi) * period.
+    for (double t = period * (1 - 0.3 / (2 * std::numbers::pi)); t < size - 1; t += period) {
+        expected += 1;
+    }
+    CHECK(zc.count() == expected);
+    CHECK(stored == expected);
+    CHECK(near(zc.period_q16(), period * 0x1p16, 0x1p16 * 1e-3));
+
+    // Position of crossing relative to block start.
+    ZeroCross<q15_t> one(100);
+    std::size_t const n = one.process(Channel<q15_t>(x.data(), 200), positions);
+    CHECK(1 == n);
+    CHECK(near(positions[0], period * (1 - 0.3 / (2 * std::numbers::pi)) * 0x1p16, 0x1p16 * 1e-2));
+
+    // Noise within hysteresis gives one crossing.
+    std::vector<q15_t> const noise = {-200, -50, 50, -50, 50, -50, 50, 200, 300};
+    ZeroCross<q15_t> noisy(100);
+    noisy.process(channel(noise));
+    CHECK(1 == noisy.count());
+}
+
+void test_dc_remover() {
+    // Offset of either sign settles exactly for shift up to 16.
+    for (int16_t const offset : {1234, -1234, 1, -1}) {
+        std::vector<q15_t> in(1 << 16, offset);
+        std::vector<q15_t> out(in.size());
+        DcRemover<q15_t> dc(12);
+        for (int k = 0; k < 8; k++) {
+            dc.process(Channel<q15_t>(in), out);
+        }
+        CHECK(offset == dc.dc());
+        CHECK(0 == out.back());
+    }
+
+    // Sine with offset: tracked offset ripples by amplitude / (2pi * 2^shift / period).
+    auto const x = sine<q15_t>(1 << 16, 8000, 100, 0, -2500);
+    std::vector<q15_t> out(x.size());
+    DcRemover<q15_t> dc(14);
+    dc.reset(-2400);
+    for (int k = 0; k < 8; k++) {
+        dc.process(Channel<q15_t>(x), out);
+    }
+    CHECK(near(dc.dc(), -2500, 8));
+    CHECK(near(rms_q15(Channel<q15_t>(out)), 8000 / std::numbers::sqrt2, 8));
+
+    // In place.
+    std::vector<q31_t> y(1000, -100000);
+    DcRemover<q31_t> dc31(4);
+    dc31.process(Channel<q31_t>(y), y);
+    CHECK(-100000 == dc31.dc());
+    CHECK(0 == y.back());
+}
+
+template <typename T>
+std::vector<T> decimate(Decimator<T>& decimator, std::vector<int16_t> const& in, std::size_t block) {
+    std::vector<T> out;
+    for (std::size_t start = 0; start < in.size(); start += block) {
+        std::size_t const n = std::min(block, in.size() - start);
+        std::vector<T> part(decimator.outputs(n));
+        CHECK(part.size() == decimator.process(Channel<int16_t>(in.data() + start, n), part));
+        out.insert(out.end(), part.begin(), part.end());
+    }
+    return out;
+}
+
+void test_decimator() {
+    // Constant 12-bit input is scaled to 15 and 31 bits after order + taps outputs.
+    std::vector<int16_t> const constant(16 * 32, 1000);
+    Decimator<q15_t> d15({.ratio = 16, .order = 3, .input_bits = 12, .output_bits = 15});
+    auto const out15 = decimate(d15, constant, constant.size());
+    CHECK(32 == out15.size());
+    CHECK(8000 == out15.back());
+
+    Decimator<q31_t> d31({.ratio = 16, .order = 3, .input_bits = 12, .output_bits = 31});
+    auto const out31 = decimate(d31, constant, constant.size());
+    CHECK(1000 << 19 == out31.back());
+
+    // Calibration: 1.5 gain and offset, negative gain inverts.
+    d15.set_calibration({.gain_q16 = 3 << 15, .offset = -7});
+    auto const calibrated = decimate(d15, constant, constant.size());
+    CHECK(11993 == calibrated.back());
+    d15.set_calibration({.gain_q16 = -(1 << 16)});
+    CHECK(-8000 == decimate(d15, constant, constant.size()).back());
+
+    // Block boundaries do not matter, blocks need not be multiple of ratio.
+    auto const x = sine<int16_t>(16 * 200, 2000, 16 * 25.3, 0, 100);
+    Decimator<q15_t> whole({.ratio = 16, .order = 4, .input_bits = 12, .output_bits = 15});
+    Decimator<q15_t> parts({.ratio = 16, .order = 4, .input_bits = 12, .output_bits = 15});
+    CHECK(decimate(whole, x, x.size()) == decimate(parts, x, 13));
+
+    // Slow sine passes with unity gain after settling, rms of 2000 amplitude scaled by 8.
+    whole.reset();
+    auto const y = decimate(whole, x, x.size());
+    Channel<q15_t> const settled(y.data() + 100, 100);
+    double const mean = double(sum_q15(settled)) / settled.size;
+    double const rms = std::sqrt(double(sum_squares_q15(settled)) / settled.size - mean * mean);
+    CHECK(near(rms, 8 * 2000 / std::numbers::sqrt2, 8 * 2000 * 0.01));
+
+    // Out of range configuration is clamped: ratio^order beyond 2^32 drops stages.
+    Decimator<q15_t> clamped({.ratio = 1024, .order = 4, .input_bits = 12, .output_bits = 15});
+    std::vector<int16_t> const long_constant(1024 * 8, -1000);
+    CHECK(-8000 == decimate(clamped, long_constant, 1000).back());
+}
+
+} // namespace
+
+int main() {
+    test_sums();
+    test_rms_power();
+    test_zero_cross();
+    test_dc_remover();
+    test_decimator();
+    if (failures) {
+        std::printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All checks passed\n");
+    return EXIT_SUCCESS;
+}